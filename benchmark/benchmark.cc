@@ -2,6 +2,9 @@
 #include <libvarintrvv.h>
 #include <cstdint>
 #include <vector>
+#include <algorithm>
+#include <chrono>
+#include <string>
 #include <random>
 #include <limits.h>
 #include <linux/perf_event.h>
@@ -17,10 +20,11 @@ extern "C"
     size_t vbyte_encode(const uint32_t *in, size_t length, uint8_t *bout);
 }
 
+template <typename T>
 struct Dataset
 {
     std::vector<uint8_t> input;
-    std::vector<uint32_t> output;
+    std::vector<T> output;
 };
 
 // Varint byte ranges:
@@ -76,18 +80,98 @@ static std::vector<uint8_t> generate_test_data(size_t num_values, uint32_t seed,
     return encoded;
 }
 
-static Dataset make_dataset(size_t num_values, uint32_t seed,
-                            int pct_1byte = 100, int pct_2byte = 0,
-                            int pct_3byte = 0, int pct_4byte = 0,
-                            int pct_5byte = 0)
+static Dataset<uint32_t> make_dataset(size_t num_values, uint32_t seed,
+                                      int pct_1byte = 100, int pct_2byte = 0,
+                                      int pct_3byte = 0, int pct_4byte = 0,
+                                      int pct_5byte = 0)
 {
-    Dataset ds;
+    Dataset<uint32_t> ds;
     ds.input = generate_test_data(num_values, seed, pct_1byte, pct_2byte,
                                   pct_3byte, pct_4byte, pct_5byte);
     ds.output.resize(num_values);
     return ds;
 }
 
+// Mixed-content stream: segments of `segment` values alternate between a mostly 1-byte distribution
+// (95/3/1/1/0) and a uniform length distribution (20/20/20/20/20)
+static Dataset<uint32_t> make_mixed_dataset(size_t num_values, uint32_t seed, size_t segment)
+{
+    Dataset<uint32_t> ds;
+    for (size_t i = 0; i < num_values; i += segment)
+    {
+        size_t n = std::min(segment, num_values - i);
+        bool uniform = (i / segment) % 2;
+        std::vector<uint8_t> part = uniform ? generate_test_data(n, seed + i, 20, 20, 20, 20, 20)
+                                            : generate_test_data(n, seed + i, 95, 3, 1, 1, 0);
+        ds.input.insert(ds.input.end(), part.begin(), part.end());
+    }
+    ds.output.resize(num_values);
+    return ds;
+}
+
+// 64-bit varint byte ranges are grouped into buckets:
+// 1 byte: 0 - 127
+// 2 bytes: 128 - 16383
+// 3-4 bytes: 16384 - 2^28-1
+// 5-8 bytes: 2^28 - 2^56-1 (e.g. timestamps)
+// 9-10 bytes: 2^56 - 2^64-1 (e.g. hashed ids, negative int64)
+
+static std::vector<uint8_t> generate_test_data_u64(size_t num_values, uint32_t seed,
+                                                   int pct_1byte, int pct_2byte,
+                                                   int pct_4byte, int pct_8byte,
+                                                   int pct_10byte)
+{
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<int> pct_dist(0, 99);
+
+    std::uniform_int_distribution<uint64_t> dist_1byte(0, 127);
+    std::uniform_int_distribution<uint64_t> dist_2byte(128, 16383);
+    std::uniform_int_distribution<uint64_t> dist_4byte(16384, (1ULL << 28) - 1);
+    std::uniform_int_distribution<uint64_t> dist_8byte(1ULL << 28, (1ULL << 56) - 1);
+    std::uniform_int_distribution<uint64_t> dist_10byte(1ULL << 56, UINT64_MAX);
+
+    std::vector<uint64_t> values(num_values);
+
+    int thresh_1 = pct_1byte;
+    int thresh_2 = thresh_1 + pct_2byte;
+    int thresh_4 = thresh_2 + pct_4byte;
+    int thresh_8 = thresh_4 + pct_8byte;
+
+    for (size_t i = 0; i < num_values; ++i)
+    {
+        int roll = pct_dist(rng);
+        if (roll < thresh_1)
+            values[i] = dist_1byte(rng);
+        else if (roll < thresh_2)
+            values[i] = dist_2byte(rng);
+        else if (roll < thresh_4)
+            values[i] = dist_4byte(rng);
+        else if (roll < thresh_8)
+            values[i] = dist_8byte(rng);
+        else
+            values[i] = dist_10byte(rng);
+    }
+
+    // Encode to varints (max 10 bytes per value)
+    std::vector<uint8_t> encoded(num_values * 10);
+    size_t encoded_size = vbyte_encode_u64(values.data(), num_values, encoded.data());
+    encoded.resize(encoded_size);
+
+    return encoded;
+}
+
+static Dataset<uint64_t> make_dataset_u64(size_t num_values, uint32_t seed,
+                                          int pct_1byte, int pct_2byte,
+                                          int pct_4byte, int pct_8byte,
+                                          int pct_10byte)
+{
+    Dataset<uint64_t> ds;
+    ds.input = generate_test_data_u64(num_values, seed, pct_1byte, pct_2byte,
+                                      pct_4byte, pct_8byte, pct_10byte);
+    ds.output.resize(num_values);
+    return ds;
+}
+
 class PerfCounter
 {
 public:
@@ -138,12 +222,9 @@ private:
     int fd_ = -1;
 };
 
-template <auto DecoderFn, int P1, int P2, int P3, int P4, int P5>
-static void BM(benchmark::State &state)
+template <auto DecoderFn, typename T>
+static void run_decode(benchmark::State &state, Dataset<T> &ds)
 {
-    const size_t num_values = static_cast<size_t>(state.range(0));
-    auto ds = make_dataset(num_values, 12345, P1, P2, P3, P4, P5);
-
     size_t total_ints = 0;
     uint64_t total_instructions = 0;
     uint64_t total_cycles = 0;
@@ -186,32 +267,656 @@ static void BM(benchmark::State &state)
     }
 }
 
+// Two-pass ZigZag decoding: plain decode followed by a separate pass over the output
+static size_t zigzag_s32_two_pass(const uint8_t *input, size_t length, int32_t *output)
+{
+    uint32_t *out = reinterpret_cast<uint32_t *>(output);
+    size_t n = varint_decode_vecshift(input, length, out);
+    for (size_t i = 0; i < n; ++i)
+        output[i] = static_cast<int32_t>((out[i] >> 1) ^ (0U - (out[i] & 1)));
+    return n;
+}
+
+static size_t zigzag_s64_two_pass(const uint8_t *input, size_t length, int64_t *output)
+{
+    uint64_t *out = reinterpret_cast<uint64_t *>(output);
+    size_t n = varint_decode_u64(input, length, out);
+    for (size_t i = 0; i < n; ++i)
+        output[i] = static_cast<int64_t>((out[i] >> 1) ^ (0ULL - (out[i] & 1)));
+    return n;
+}
+
+static size_t delta_u32_fused(const uint8_t *input, size_t length, uint32_t *output)
+{
+    return varint_decode_delta_u32(input, length, output, 0);
+}
+
+// Two-pass delta decoding: plain decode followed by a scalar prefix sum
+static size_t delta_u32_two_pass(const uint8_t *input, size_t length, uint32_t *output)
+{
+    size_t n = varint_decode_vecshift(input, length, output);
+    for (size_t i = 1; i < n; ++i)
+        output[i] += output[i - 1];
+    return n;
+}
+
+static size_t delta_u64_fused(const uint8_t *input, size_t length, uint64_t *output)
+{
+    return varint_decode_delta_u64(input, length, output, 0);
+}
+
+static size_t delta_u64_two_pass(const uint8_t *input, size_t length, uint64_t *output)
+{
+    size_t n = varint_decode_u64(input, length, output);
+    for (size_t i = 1; i < n; ++i)
+        output[i] += output[i - 1];
+    return n;
+}
+
+static size_t vecshift_safe(const uint8_t *input, size_t length, uint32_t *output)
+{
+    size_t values_written, bytes_consumed;
+    varint_decode_vecshift_safe(input, length, output, &values_written, &bytes_consumed);
+    return values_written;
+}
+
+static bool scalar_validate(const uint8_t *input, size_t length)
+{
+    size_t pos = 0;
+    while (pos < length)
+    {
+        size_t i = 0;
+        while (i < 5 && pos + i < length && input[pos + i] > 0x7F)
+            ++i;
+        if (i == 5 || pos + i == length || (i == 4 && input[pos + i] > 0x0F))
+            return false;
+        pos += i + 1;
+    }
+    return true;
+}
+
+// Separate scalar validation pass in front of the unchecked decoder
+static size_t vecshift_validate_two_pass(const uint8_t *input, size_t length, uint32_t *output)
+{
+    if (!scalar_validate(input, length))
+        return 0;
+    return varint_decode_vecshift(input, length, output);
+}
+
+// Validation only, the output buffer is not touched
+static size_t validate_rvv(const uint8_t *input, size_t length, uint32_t *)
+{
+    return varint_validate(input, length) == VARINT_OK ? length : 0;
+}
+
+static size_t validate_scalar(const uint8_t *input, size_t length, uint32_t *)
+{
+    return scalar_validate(input, length) ? length : 0;
+}
+
+// Counting only, the output buffer is not touched
+static size_t count_rvv(const uint8_t *input, size_t length, uint32_t *)
+{
+    return varint_count(input, length);
+}
+
+static size_t count_lengths_rvv(const uint8_t *input, size_t length, uint32_t *)
+{
+    size_t histogram[5];
+    size_t n = varint_count_lengths(input, length, histogram);
+    benchmark::DoNotOptimize(histogram);
+    return n;
+}
+
+static size_t count_scalar(const uint8_t *input, size_t length, uint32_t *)
+{
+    size_t n = 0;
+    for (size_t i = 0; i < length; ++i)
+        n += input[i] < 0x80;
+    return n;
+}
+
+// Offset of the varint with index length / 2, returned in place of a count
+static size_t skip_rvv(const uint8_t *input, size_t length, uint32_t *)
+{
+    return varint_skip(input, length, length / 2);
+}
+
+static size_t skip_scalar(const uint8_t *input, size_t length, uint32_t *)
+{
+    size_t k = length / 2;
+    size_t pos = 0;
+    while (pos < length && k > 0)
+        k -= input[pos++] < 0x80;
+    return pos;
+}
+
+// Capacity bounded decoding in batches into the same 4 KB output buffer
+static size_t bounded_4k(const uint8_t *input, size_t length, uint32_t *output)
+{
+    size_t n = 0;
+    while (length > 0)
+    {
+        size_t consumed;
+        size_t values = varint_decode_vecshift_bounded(input, length, output, 1024, &consumed);
+        benchmark::ClobberMemory();
+        if (values == 0)
+            break;
+        n += values;
+        input += consumed;
+        length -= consumed;
+    }
+    return n;
+}
+
+static size_t decode_carry(const uint8_t *input, size_t length, uint32_t *output)
+{
+    size_t consumed;
+    return varint_decode_vecshift_carry(input, length, output, &consumed);
+}
+
+template <size_t Threads>
+static size_t decode_parallel(const uint8_t *input, size_t length, uint32_t *output)
+{
+    return varint_decode_parallel(input, length, output, Threads);
+}
+
+template <size_t Distance>
+static size_t decode_prefetch(const uint8_t *input, size_t length, uint32_t *output)
+{
+    return varint_decode_prefetch(input, length, output, Distance);
+}
+
+// Streaming decoder fed in chunks of Chunk bytes
+template <size_t Chunk>
+static size_t stream_chunked(const uint8_t *input, size_t length, uint32_t *output)
+{
+    varint_stream stream;
+    varint_stream_init(&stream);
+    size_t n = 0;
+    for (size_t pos = 0; pos < length; pos += Chunk)
+        n += varint_stream_feed(&stream, input + pos, std::min(Chunk, length - pos), output + n);
+    varint_stream_finish(&stream);
+    return n;
+}
+
+template <auto DecoderFn, int P1, int P2, int P3, int P4, int P5>
+static void BM(benchmark::State &state)
+{
+    const size_t num_values = static_cast<size_t>(state.range(0));
+    auto ds = make_dataset(num_values, 12345, P1, P2, P3, P4, P5);
+    run_decode<DecoderFn>(state, ds);
+}
+
+template <auto DecoderFn, int Segment>
+static void BM_mixed(benchmark::State &state)
+{
+    const size_t num_values = static_cast<size_t>(state.range(0));
+    auto ds = make_mixed_dataset(num_values, 12345, Segment);
+    run_decode<DecoderFn>(state, ds);
+}
+
+// P1..P5: percentage of 1, 2, 3-4, 5-8 and 9-10 byte varints
+template <auto DecoderFn, int P1, int P2, int P3, int P4, int P5>
+static void BM_u64(benchmark::State &state)
+{
+    const size_t num_values = static_cast<size_t>(state.range(0));
+    auto ds = make_dataset_u64(num_values, 12345, P1, P2, P3, P4, P5);
+    run_decode<DecoderFn>(state, ds);
+}
+
+// signed (ZigZag) decoders, any varint stream is a valid ZigZag stream
+template <auto DecoderFn, int P1, int P2, int P3, int P4, int P5>
+static void BM_s32(benchmark::State &state)
+{
+    const size_t num_values = static_cast<size_t>(state.range(0));
+    Dataset<int32_t> ds;
+    ds.input = generate_test_data(num_values, 12345, P1, P2, P3, P4, P5);
+    ds.output.resize(num_values);
+    run_decode<DecoderFn>(state, ds);
+}
+
+// narrow output decoders
+template <auto DecoderFn, int P1, int P2, int P3, int P4, int P5>
+static void BM_u16(benchmark::State &state)
+{
+    const size_t num_values = static_cast<size_t>(state.range(0));
+    Dataset<uint16_t> ds;
+    ds.input = generate_test_data(num_values, 12345, P1, P2, P3, P4, P5);
+    ds.output.resize(num_values);
+    run_decode<DecoderFn>(state, ds);
+}
+
+template <auto DecoderFn, int P1, int P2, int P3, int P4, int P5>
+static void BM_u8(benchmark::State &state)
+{
+    const size_t num_values = static_cast<size_t>(state.range(0));
+    Dataset<uint8_t> ds;
+    ds.input = generate_test_data(num_values, 12345, P1, P2, P3, P4, P5);
+    ds.output.resize(num_values);
+    run_decode<DecoderFn>(state, ds);
+}
+
+template <auto DecoderFn, int P1, int P2, int P3, int P4, int P5>
+static void BM_s64(benchmark::State &state)
+{
+    const size_t num_values = static_cast<size_t>(state.range(0));
+    Dataset<int64_t> ds;
+    ds.input = generate_test_data_u64(num_values, 12345, P1, P2, P3, P4, P5);
+    ds.output.resize(num_values);
+    run_decode<DecoderFn>(state, ds);
+}
+
 // BENCHMARK_TEMPLATE(BM, varint_rvv, 95, 2, 1, 1, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
 // BENCHMARK_TEMPLATE(BM, varint_decode_vecshift, 95, 2, 1, 1, 1)->RangeMultiplier(2)->Range(1 << 10, 1 << 20);
 BENCHMARK_TEMPLATE(BM, varint_decode_vecshift, 95, 2, 1, 1, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
 BENCHMARK_TEMPLATE(BM, varint_decode_scalar, 95, 2, 1, 1, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_decode_vecshift_m2, 95, 2, 1, 1, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_decode_vecshift_m4, 95, 2, 1, 1, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_decode_vecshift_pipelined, 95, 2, 1, 1, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, decode_carry, 95, 2, 1, 1, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_decode_vecshift_uniform, 95, 2, 1, 1, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_rvv, 95, 2, 1, 1, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_rvv_m2, 95, 2, 1, 1, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_rvv_m4, 95, 2, 1, 1, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_decode, 95, 2, 1, 1, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_decode_masked_vbyte, 95, 2, 1, 1, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_decode_adaptive, 95, 2, 1, 1, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
 
 // BENCHMARK_TEMPLATE(BM, varint_rvv, 20, 20, 20, 20, 20)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
 // BENCHMARK_TEMPLATE(BM, varint_decode_vecshift, 20, 20, 20, 20, 20)->RangeMultiplier(2)->Range(1 << 10, 1 << 20);
 // BENCHMARK_TEMPLATE(BM, varint_decode_vecshift_test, 20, 20, 20, 20, 20)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
 // BENCHMARK_TEMPLATE(BM, varint_decode_scalar, 20, 20, 20, 20, 20)->RangeMultiplier(2)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_decode_vecshift, 20, 20, 20, 20, 20)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_decode_vecshift_m2, 20, 20, 20, 20, 20)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_decode_vecshift_m4, 20, 20, 20, 20, 20)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_decode_vecshift_pipelined, 20, 20, 20, 20, 20)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, decode_carry, 20, 20, 20, 20, 20)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_rvv, 20, 20, 20, 20, 20)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_rvv_m2, 20, 20, 20, 20, 20)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_rvv_m4, 20, 20, 20, 20, 20)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_decode, 20, 20, 20, 20, 20)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_decode_masked_vbyte, 20, 20, 20, 20, 20)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_decode_adaptive, 20, 20, 20, 20, 20)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+
+// Many small buffers of 10-200 bytes cut at varint boundaries, decoded with one batch call or one call per buffer
+template <bool Batch>
+static void BM_batch(benchmark::State &state)
+{
+    const size_t num_values = static_cast<size_t>(state.range(0));
+    auto ds = make_dataset(num_values, 12345, 90, 4, 3, 2, 1);
+
+    std::mt19937 rng(12345);
+    std::vector<varint_batch_entry> entries;
+    size_t pos = 0, values = 0;
+    while (pos < ds.input.size())
+    {
+        size_t end = std::min(ds.input.size(), pos + 10 + rng() % 191);
+        while (end < ds.input.size() && ds.input[end - 1] > 0x7F)
+            ++end;
+        size_t count = 0;
+        for (size_t i = pos; i < end; ++i)
+            count += ds.input[i] < 0x80;
+        entries.push_back({ds.input.data() + pos, end - pos, ds.output.data() + values, 0});
+        values += count;
+        pos = end;
+    }
+
+    for (auto _ : state)
+    {
+        size_t n = 0;
+        if (Batch)
+            n = varint_decode_batch(entries.data(), entries.size());
+        else
+            for (const auto &entry : entries)
+                n += varint_decode_vecshift(entry.input, entry.length, entry.output);
+        benchmark::DoNotOptimize(n);
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(ds.input.size()));
+    state.SetItemsProcessed(int64_t(state.iterations()) * int64_t(entries.size()));
+}
+
+// The dataset split into Streams columns at varint boundaries, decoded in lockstep or one column after the other
+template <size_t Streams, bool Lockstep>
+static void BM_multi(benchmark::State &state)
+{
+    const size_t num_values = static_cast<size_t>(state.range(0));
+    auto ds = make_dataset(num_values, 12345, 90, 4, 3, 2, 1);
+
+    std::vector<varint_batch_entry> streams;
+    size_t pos = 0, values = 0;
+    for (size_t s = 1; s <= Streams; ++s)
+    {
+        size_t end = s == Streams ? ds.input.size() : ds.input.size() / Streams * s;
+        while (end < ds.input.size() && ds.input[end - 1] > 0x7F)
+            ++end;
+        size_t count = 0;
+        for (size_t i = pos; i < end; ++i)
+            count += ds.input[i] < 0x80;
+        streams.push_back({ds.input.data() + pos, end - pos, ds.output.data() + values, 0});
+        values += count;
+        pos = end;
+    }
+
+    for (auto _ : state)
+    {
+        size_t n = 0;
+        if (Lockstep)
+            n = varint_decode_multi(streams.data(), streams.size());
+        else
+            for (const auto &stream : streams)
+                n += varint_decode_vecshift(stream.input, stream.length, stream.output);
+        benchmark::DoNotOptimize(n);
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(ds.input.size()));
+}
+
+// Uneven batch: three large columns with half of the bytes and many small buffers of 10-2000 bytes, decoded with
+// Threads threads. util<t> is the share of the wall time thread t spent decoding.
+template <size_t Threads>
+static void BM_batch_parallel(benchmark::State &state)
+{
+    const size_t num_values = static_cast<size_t>(state.range(0));
+    auto ds = make_dataset(num_values, 12345, 90, 4, 3, 2, 1);
+
+    std::mt19937 rng(12345);
+    std::vector<varint_batch_entry> entries;
+    size_t pos = 0, values = 0;
+    while (pos < ds.input.size())
+    {
+        size_t size = entries.size() < 3 ? ds.input.size() / 6 : 10 + rng() % 1991;
+        size_t end = std::min(ds.input.size(), pos + size);
+        while (end < ds.input.size() && ds.input[end - 1] > 0x7F)
+            ++end;
+        size_t count = 0;
+        for (size_t i = pos; i < end; ++i)
+            count += ds.input[i] < 0x80;
+        entries.push_back({ds.input.data() + pos, end - pos, ds.output.data() + values, 0});
+        values += count;
+        pos = end;
+    }
+
+    std::vector<varint_thread_stats> stats(Threads, varint_thread_stats{0, 0, 0});
+    uint64_t wall_ns = 0;
+    for (auto _ : state)
+    {
+        auto start = std::chrono::steady_clock::now();
+        size_t n = varint_decode_batch_parallel(entries.data(), entries.size(), Threads, stats.data());
+        wall_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        benchmark::DoNotOptimize(n);
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(ds.input.size()));
+
+    size_t steals = 0;
+    for (size_t t = 0; t < Threads; ++t)
+    {
+        state.counters["util" + std::to_string(t)] = double(stats[t].busy_ns) / double(wall_ns);
+        steals += stats[t].steals;
+    }
+    state.counters["steals"] = benchmark::Counter(double(steals), benchmark::Counter::kAvgIterations);
+}
+
+// Encoding of the values of a dataset with Threads threads, 0 for the sequential vbyte_encode
+template <size_t Threads>
+static void BM_encode(benchmark::State &state)
+{
+    const size_t num_values = static_cast<size_t>(state.range(0));
+    auto ds = make_dataset(num_values, 12345, 90, 4, 3, 2, 1);
+    std::vector<uint32_t> values(num_values);
+    varint_decode_vecshift(ds.input.data(), ds.input.size(), values.data());
+
+    for (auto _ : state)
+    {
+        size_t n = Threads == 0 ? vbyte_encode(values.data(), num_values, ds.input.data())
+                                : vbyte_encode_parallel(values.data(), num_values, ds.input.data(), Threads);
+        benchmark::DoNotOptimize(n);
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(ds.input.size()));
+    state.SetItemsProcessed(int64_t(state.iterations()) * int64_t(num_values));
+}
+
+// Cache pollution: after every decode a hot working set of 256 KB (L2 resident) is read again, hot_ns is the time
+// of that walk. The more lines the decode evicted, the longer the walk takes.
+template <auto DecoderFn>
+static void BM_pollution(benchmark::State &state)
+{
+    const size_t num_values = static_cast<size_t>(state.range(0));
+    auto ds = make_dataset(num_values, 12345, 90, 4, 3, 2, 1);
+    std::vector<uint64_t> hot(256 * 1024 / sizeof(uint64_t), 1);
+
+    uint64_t hot_ns = 0;
+    for (auto _ : state)
+    {
+        size_t n = DecoderFn(ds.input.data(), ds.input.size(), ds.output.data());
+        benchmark::DoNotOptimize(n);
+        benchmark::ClobberMemory();
+
+        auto start = std::chrono::steady_clock::now();
+        uint64_t sum = 0;
+        for (size_t i = 0; i < hot.size(); i += 8)
+            sum += hot[i];
+        benchmark::DoNotOptimize(sum);
+        hot_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(ds.input.size()));
+    state.counters["hot_ns"] = benchmark::Counter(double(hot_ns), benchmark::Counter::kAvgIterations);
+}
+
+// Block-indexed container: decodes Range values at random positions per iteration, Range = 0 decodes everything
+template <size_t Range>
+static void BM_blocks(benchmark::State &state)
+{
+    const size_t num_values = static_cast<size_t>(state.range(0));
+    auto ds = make_dataset(num_values, 12345, 90, 4, 3, 2, 1);
+    std::vector<uint32_t> values(num_values);
+    varint_decode_vecshift(ds.input.data(), ds.input.size(), values.data());
+
+    std::vector<uint8_t> container(varint_blocks_max_size(num_values, 256, VARINT_BLOCKS_MINMAX));
+    container.resize(varint_blocks_encode(values.data(), num_values, 256, VARINT_BLOCKS_MINMAX, container.data()));
+    varint_blocks blocks;
+    varint_blocks_open(&blocks, container.data(), container.size());
+
+    std::mt19937 rng(12345);
+    size_t total_ints = 0;
+    for (auto _ : state)
+    {
+        size_t n = Range == 0 ? varint_blocks_decode(&blocks, ds.output.data())
+                              : varint_blocks_decode_range(&blocks, rng() % num_values, Range, ds.output.data());
+        total_ints += n;
+        benchmark::DoNotOptimize(n);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(int64_t(total_ints));
+}
 
 // Distribution: 90% 1-byte, 4% 2-byte, 3% 3-byte, 2% 4-byte, 1% 5-byte (small values)
 // BENCHMARK_TEMPLATE(BM, varint_rvv, 90, 4, 3, 2, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
 // BENCHMARK_TEMPLATE(BM, varint_decode_vecshift, 90, 4, 3, 2, 1)->RangeMultiplier(2)->Range(1 << 10, 1 << 20);
 BENCHMARK_TEMPLATE(BM, varint_decode_vecshift, 90, 4, 3, 2, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
 BENCHMARK_TEMPLATE(BM, varint_decode_scalar, 90, 4, 3, 2, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_decode_vecshift_m2, 90, 4, 3, 2, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_decode_vecshift_m4, 90, 4, 3, 2, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_decode_vecshift_pipelined, 90, 4, 3, 2, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, decode_carry, 90, 4, 3, 2, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_rvv, 90, 4, 3, 2, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_rvv_m2, 90, 4, 3, 2, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_rvv_m4, 90, 4, 3, 2, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_decode, 90, 4, 3, 2, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_decode_masked_vbyte, 90, 4, 3, 2, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_decode_adaptive, 90, 4, 3, 2, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
 
 // Distribution: 81% 1-byte, 7% 2-byte, 6% 3-byte, 5% 4-byte, 1% 5-byte (mixed)
 // BENCHMARK_TEMPLATE(BM, varint_rvv, 81, 7, 6, 5, 1)->RangeMultiplier(2)->Range(1 << 10, 1 << 20);
 // BENCHMARK_TEMPLATE(BM, varint_decode_vecshift, 81, 7, 6, 5, 1)->RangeMultiplier(2)->Range(1 << 10, 1 << 20);
 BENCHMARK_TEMPLATE(BM, varint_decode_vecshift, 81, 7, 6, 5, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
 BENCHMARK_TEMPLATE(BM, varint_decode_scalar, 81, 7, 6, 5, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_decode_vecshift_m2, 81, 7, 6, 5, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_decode_vecshift_m4, 81, 7, 6, 5, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_decode_vecshift_pipelined, 81, 7, 6, 5, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, decode_carry, 81, 7, 6, 5, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_rvv, 81, 7, 6, 5, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_rvv_m2, 81, 7, 6, 5, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_rvv_m4, 81, 7, 6, 5, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_decode, 81, 7, 6, 5, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_decode_masked_vbyte, 81, 7, 6, 5, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_decode_adaptive, 81, 7, 6, 5, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
 
 // Distribution: 72% 1-byte, 13% 2-byte, 9% 3-byte, 5% 4-byte, 1% 5-byte (mixed)
 // BENCHMARK_TEMPLATE(BM, varint_rvv, 72, 13, 9, 5, 1)->RangeMultiplier(2)->Range(1 << 10, 1 << 20);
 // BENCHMARK_TEMPLATE(BM, varint_decode_vecshift, 72, 13, 9, 5, 1)->RangeMultiplier(2)->Range(1 << 10, 1 << 20);
 BENCHMARK_TEMPLATE(BM, varint_decode_vecshift, 72, 13, 9, 5, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
 BENCHMARK_TEMPLATE(BM, varint_decode_scalar, 72, 13, 9, 5, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_decode_vecshift_m2, 72, 13, 9, 5, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_decode_vecshift_m4, 72, 13, 9, 5, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_decode_vecshift_pipelined, 72, 13, 9, 5, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, decode_carry, 72, 13, 9, 5, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_rvv, 72, 13, 9, 5, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_rvv_m2, 72, 13, 9, 5, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_rvv_m4, 72, 13, 9, 5, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_decode, 72, 13, 9, 5, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_decode_masked_vbyte, 72, 13, 9, 5, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_decode_adaptive, 72, 13, 9, 5, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+
+// Distributions dominated by 2-byte values (e.g. timestamp deltas) and by 3-byte values, pure 2-byte and 3-byte
+// streams, to compare the uniform fast paths with the vcompress path of vecshift
+BENCHMARK_TEMPLATE(BM, varint_decode_vecshift, 5, 90, 3, 1, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_decode_vecshift_uniform, 5, 90, 3, 1, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_decode_vecshift_m2, 5, 90, 3, 1, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, decode_carry, 5, 90, 3, 1, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_rvv, 5, 90, 3, 1, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_decode_scalar, 5, 90, 3, 1, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+
+BENCHMARK_TEMPLATE(BM, varint_decode_vecshift, 5, 5, 85, 4, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_decode_vecshift_uniform, 5, 5, 85, 4, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_decode_vecshift_m2, 5, 5, 85, 4, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, decode_carry, 5, 5, 85, 4, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_rvv, 5, 5, 85, 4, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_decode_scalar, 5, 5, 85, 4, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+
+BENCHMARK_TEMPLATE(BM, varint_decode_vecshift, 0, 100, 0, 0, 0)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_decode_vecshift_uniform, 0, 100, 0, 0, 0)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+
+BENCHMARK_TEMPLATE(BM, varint_decode_vecshift, 0, 0, 100, 0, 0)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_decode_vecshift_uniform, 0, 0, 100, 0, 0)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+
+// Mixed-content streams, segments of 4096 / 256 values alternate between 95/3/1/1/0 and 20/20/20/20/20
+BENCHMARK_TEMPLATE(BM_mixed, varint_decode_vecshift, 4096)->RangeMultiplier(2)->Range(1 << 14, 1 << 20);
+BENCHMARK_TEMPLATE(BM_mixed, varint_decode, 4096)->RangeMultiplier(2)->Range(1 << 14, 1 << 20);
+BENCHMARK_TEMPLATE(BM_mixed, varint_decode_masked_vbyte, 4096)->RangeMultiplier(2)->Range(1 << 14, 1 << 20);
+BENCHMARK_TEMPLATE(BM_mixed, varint_decode_adaptive, 4096)->RangeMultiplier(2)->Range(1 << 14, 1 << 20);
+BENCHMARK_TEMPLATE(BM_mixed, varint_decode_vecshift, 256)->RangeMultiplier(2)->Range(1 << 14, 1 << 20);
+BENCHMARK_TEMPLATE(BM_mixed, varint_decode, 256)->RangeMultiplier(2)->Range(1 << 14, 1 << 20);
+BENCHMARK_TEMPLATE(BM_mixed, varint_decode_masked_vbyte, 256)->RangeMultiplier(2)->Range(1 << 14, 1 << 20);
+BENCHMARK_TEMPLATE(BM_mixed, varint_decode_adaptive, 256)->RangeMultiplier(2)->Range(1 << 14, 1 << 20);
+
+// 64-bit decoders. Distribution: 60% 1-byte, 10% 2-byte, 10% 3-4 byte, 15% 5-8 byte, 5% 9-10 byte (mixed int64 fields)
+BENCHMARK_TEMPLATE(BM_u64, varint_decode_u64, 60, 10, 10, 15, 5)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM_u64, varint_decode_scalar_u64, 60, 10, 10, 15, 5)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+
+// Distribution: 10% 1-byte, 0% 2-byte, 10% 3-4 byte, 80% 5-8 byte, 0% 9-10 byte (timestamps)
+BENCHMARK_TEMPLATE(BM_u64, varint_decode_u64, 10, 0, 10, 80, 0)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM_u64, varint_decode_scalar_u64, 10, 0, 10, 80, 0)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+
+// ZigZag: fused vs two-pass
+BENCHMARK_TEMPLATE(BM_s32, varint_decode_zigzag_s32, 90, 4, 3, 2, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM_s32, zigzag_s32_two_pass, 90, 4, 3, 2, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM_s64, varint_decode_zigzag_s64, 60, 10, 10, 15, 5)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM_s64, zigzag_s64_two_pass, 60, 10, 10, 15, 5)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+
+// Delta / prefix sum: fused vs two-pass. Distribution: 70% 1-byte, 25% 2-byte, 5% 3-byte (posting list gaps)
+BENCHMARK_TEMPLATE(BM, delta_u32_fused, 70, 25, 5, 0, 0)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, delta_u32_two_pass, 70, 25, 5, 0, 0)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM_u64, delta_u64_fused, 70, 25, 5, 0, 0)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM_u64, delta_u64_two_pass, 70, 25, 5, 0, 0)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+
+// Narrow outputs vs 32-bit output on the same data
+BENCHMARK_TEMPLATE(BM_u16, varint_decode_u16, 95, 4, 1, 0, 0)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_decode_vecshift, 95, 4, 1, 0, 0)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM_u8, varint_decode_u8, 100, 0, 0, 0, 0)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM_u16, varint_decode_u16, 100, 0, 0, 0, 0)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_decode_vecshift, 100, 0, 0, 0, 0)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+
+// Bounds-checked decoding: checks in the vector loop vs scalar validation pass vs unchecked
+BENCHMARK_TEMPLATE(BM, vecshift_safe, 90, 4, 3, 2, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, vecshift_validate_two_pass, 90, 4, 3, 2, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_decode_vecshift, 90, 4, 3, 2, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, vecshift_safe, 20, 20, 20, 20, 20)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, vecshift_validate_two_pass, 20, 20, 20, 20, 20)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_decode_vecshift, 20, 20, 20, 20, 20)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+
+// Validation only: vector vs scalar
+BENCHMARK_TEMPLATE(BM, validate_rvv, 90, 4, 3, 2, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, validate_scalar, 90, 4, 3, 2, 1)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, validate_rvv, 20, 20, 20, 20, 20)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, validate_scalar, 20, 20, 20, 20, 20)->RangeMultiplier(2)->Range(1 << 8, 1 << 20);
+
+// Streaming: 4 KB / 64 KB chunks vs one call
+BENCHMARK_TEMPLATE(BM, stream_chunked<4096>, 90, 4, 3, 2, 1)->RangeMultiplier(4)->Range(1 << 14, 1 << 20);
+BENCHMARK_TEMPLATE(BM, stream_chunked<65536>, 90, 4, 3, 2, 1)->RangeMultiplier(4)->Range(1 << 14, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_decode, 90, 4, 3, 2, 1)->RangeMultiplier(4)->Range(1 << 14, 1 << 20);
+
+// Capacity bounded: 4 KB output buffer vs output array for the whole input
+BENCHMARK_TEMPLATE(BM, bounded_4k, 90, 4, 3, 2, 1)->RangeMultiplier(4)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, varint_decode_vecshift, 90, 4, 3, 2, 1)->RangeMultiplier(4)->Range(1 << 8, 1 << 20);
+
+// Counting: vector count, fused count and length histogram, scalar count
+BENCHMARK_TEMPLATE(BM, count_rvv, 90, 4, 3, 2, 1)->RangeMultiplier(4)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, count_lengths_rvv, 90, 4, 3, 2, 1)->RangeMultiplier(4)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, count_scalar, 90, 4, 3, 2, 1)->RangeMultiplier(4)->Range(1 << 8, 1 << 20);
+
+// Skip: locate a varint in the second half of the input
+BENCHMARK_TEMPLATE(BM, skip_rvv, 90, 4, 3, 2, 1)->RangeMultiplier(4)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM, skip_scalar, 90, 4, 3, 2, 1)->RangeMultiplier(4)->Range(1 << 8, 1 << 20);
+
+// Block-indexed container: whole column and random ranges of 64 values
+BENCHMARK_TEMPLATE(BM_blocks, 0)->RangeMultiplier(4)->Range(1 << 12, 1 << 20);
+BENCHMARK_TEMPLATE(BM_blocks, 64)->RangeMultiplier(4)->Range(1 << 12, 1 << 20);
+
+// Multi-threaded decoding of one buffer, 1-8 threads
+BENCHMARK_TEMPLATE(BM, decode_parallel<1>, 90, 4, 3, 2, 1)->RangeMultiplier(4)->Range(1 << 18, 1 << 22)->UseRealTime();
+BENCHMARK_TEMPLATE(BM, decode_parallel<2>, 90, 4, 3, 2, 1)->RangeMultiplier(4)->Range(1 << 18, 1 << 22)->UseRealTime();
+BENCHMARK_TEMPLATE(BM, decode_parallel<4>, 90, 4, 3, 2, 1)->RangeMultiplier(4)->Range(1 << 18, 1 << 22)->UseRealTime();
+BENCHMARK_TEMPLATE(BM, decode_parallel<8>, 90, 4, 3, 2, 1)->RangeMultiplier(4)->Range(1 << 18, 1 << 22)->UseRealTime();
+
+// Encoding: sequential vs 1-8 threads
+BENCHMARK_TEMPLATE(BM_encode, 0)->RangeMultiplier(4)->Range(1 << 18, 1 << 22)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_encode, 1)->RangeMultiplier(4)->Range(1 << 18, 1 << 22)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_encode, 2)->RangeMultiplier(4)->Range(1 << 18, 1 << 22)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_encode, 4)->RangeMultiplier(4)->Range(1 << 18, 1 << 22)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_encode, 8)->RangeMultiplier(4)->Range(1 << 18, 1 << 22)->UseRealTime();
+
+// Small buffers: batch call vs one call per buffer, items are buffers
+BENCHMARK_TEMPLATE(BM_batch, true)->RangeMultiplier(4)->Range(1 << 10, 1 << 18);
+BENCHMARK_TEMPLATE(BM_batch, false)->RangeMultiplier(4)->Range(1 << 10, 1 << 18);
+
+// Independent streams: lockstep vs one after the other
+BENCHMARK_TEMPLATE(BM_multi, 2, true)->RangeMultiplier(4)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(BM_multi, 2, false)->RangeMultiplier(4)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(BM_multi, 4, true)->RangeMultiplier(4)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(BM_multi, 4, false)->RangeMultiplier(4)->Range(1 << 10, 1 << 20);
+
+// Uneven batches with work stealing, 1-8 threads
+BENCHMARK_TEMPLATE(BM_batch_parallel, 1)->RangeMultiplier(4)->Range(1 << 18, 1 << 22)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_batch_parallel, 2)->RangeMultiplier(4)->Range(1 << 18, 1 << 22)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_batch_parallel, 4)->RangeMultiplier(4)->Range(1 << 18, 1 << 22)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_batch_parallel, 8)->RangeMultiplier(4)->Range(1 << 18, 1 << 22)->UseRealTime();
+
+// Large buffers up to 64 MB of input: plain vs L1-blocked with prefetch distances of 1 KB up to 32 KB (8 pages)
+BENCHMARK_TEMPLATE(BM, varint_decode, 95, 2, 1, 1, 1)->RangeMultiplier(4)->Range(1 << 12, 1 << 26);
+BENCHMARK_TEMPLATE(BM, decode_prefetch<1024>, 95, 2, 1, 1, 1)->RangeMultiplier(4)->Range(1 << 12, 1 << 26);
+BENCHMARK_TEMPLATE(BM, decode_prefetch<4096>, 95, 2, 1, 1, 1)->RangeMultiplier(4)->Range(1 << 12, 1 << 26);
+BENCHMARK_TEMPLATE(BM, decode_prefetch<8192>, 95, 2, 1, 1, 1)->RangeMultiplier(4)->Range(1 << 12, 1 << 26);
+BENCHMARK_TEMPLATE(BM, decode_prefetch<16384>, 95, 2, 1, 1, 1)->RangeMultiplier(4)->Range(1 << 12, 1 << 26);
+BENCHMARK_TEMPLATE(BM, decode_prefetch<32768>, 95, 2, 1, 1, 1)->RangeMultiplier(4)->Range(1 << 12, 1 << 26);
+
+// Non-temporal output stores: throughput and cache pollution
+BENCHMARK_TEMPLATE(BM, varint_decode_nt, 90, 4, 3, 2, 1)->RangeMultiplier(4)->Range(1 << 16, 1 << 22);
+BENCHMARK_TEMPLATE(BM, varint_decode_vecshift, 90, 4, 3, 2, 1)->RangeMultiplier(4)->Range(1 << 16, 1 << 22);
+BENCHMARK_TEMPLATE(BM_pollution, varint_decode_nt)->RangeMultiplier(4)->Range(1 << 16, 1 << 22);
+BENCHMARK_TEMPLATE(BM_pollution, varint_decode_vecshift)->RangeMultiplier(4)->Range(1 << 16, 1 << 22);
 
 BENCHMARK_MAIN();
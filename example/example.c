@@ -167,6 +167,32 @@ int main(void)
         }
     }
 
+    /* Compare Masked VByte with the scalar decoder, the register holds VLEN/128 groups */
+    uint32_t *scalar_values = malloc(N * sizeof(uint32_t));
+    if (!scalar_values)
+    {
+        fprintf(stderr, "Failed to allocate memory\n");
+        return 1;
+    }
+    size_t scalar_count = varint_decode_scalar(encoded_data, (int)encoded_length, scalar_values);
+    size_t masked_count = varint_decode_masked_vbyte(encoded_data, encoded_length, decoded_values);
+    if (masked_count != scalar_count)
+    {
+        printf("ERROR: Masked VByte decoded %zu integers, scalar %zu\n", masked_count, scalar_count);
+        errors++;
+    }
+    for (size_t i = 0; i < scalar_count && i < masked_count; i++)
+    {
+        if (decoded_values[i] != scalar_values[i])
+        {
+            printf("ERROR Masked VByte at index %zu: expected %u, got %u\n",
+                   i, scalar_values[i], decoded_values[i]);
+            errors++;
+            break;
+        }
+    }
+    free(scalar_values);
+
     /* Report summary */
     if (errors == 0)
     {
@@ -8,15 +8,147 @@ extern "C"
 
 #include <stdint.h>
 #include <stdio.h>
+// the runtime dispatch and the scalar decoders are also built without the V extension
+#ifdef __riscv_vector
 #include "riscv_vector.h"
+#endif
+
+    // result of the checked decoders
+    typedef enum varint_status
+    {
+        VARINT_OK = 0,
+        VARINT_TRUNCATED,  // input ends inside a varint
+        VARINT_OVERLONG,   // varint longer than 5 (10 for 64-bit) bytes
+        VARINT_OVERFLOW,   // last byte of a 5 (10) byte varint has payload bits above bit 31 (63)
+        VARINT_CORRUPT,    // inconsistent container header or index
+    } varint_status;
+
+    // decodes with the fastest kernel supported by the CPU, selected at load time
+    size_t varint_decode(const uint8_t *input, size_t length, uint32_t *output);
+    // counts the varints with varint_count, or with a scalar loop on cores that can not run it
+    size_t varint_decode_count(const uint8_t *input, size_t length);
+    // splits the input at termination bytes and decodes the parts on num_threads threads, 0 for all CPUs
+    size_t varint_decode_parallel(const uint8_t *input, size_t length, uint32_t *output, size_t num_threads);
 
     size_t varint_decode_masked_vbyte(const uint8_t *input, size_t length, uint32_t *output);
     size_t varint_decode_scalar(const uint8_t *input, int length, uint32_t *output);
     size_t vbyte_encode(const uint32_t *in, size_t length, uint8_t *bout);
+    size_t vbyte_encoded_size(const uint32_t *in, size_t length);
+    size_t vbyte_encode_parallel(const uint32_t *in, size_t length, uint8_t *bout, size_t num_threads);
     size_t varint_decode_vecshift(const uint8_t *input, size_t length, uint32_t *output);
     size_t varint_decode_vecshift_test_m2(const uint8_t *input, size_t length, uint32_t *output);
     size_t varint_rvv(const uint8_t *input, size_t length, uint32_t *output);
     size_t varint_decode_vecshift_m2(const uint8_t *input, size_t length, uint32_t *output);
+    size_t varint_decode_vecshift_m4(const uint8_t *input, size_t length, uint32_t *output);
+    size_t varint_decode_vecshift_pipelined(const uint8_t *input, size_t length, uint32_t *output);
+    // stops at a truncated or malformed varint, bytes_consumed tells where
+    size_t varint_decode_vecshift_carry(const uint8_t *input, size_t length, uint32_t *output, size_t *bytes_consumed);
+    size_t varint_decode_vecshift_uniform(const uint8_t *input, size_t length, uint32_t *output);
+    // L1-blocked decoding with prefetching distance bytes ahead (0 for the default), for buffers beyond L2
+    size_t varint_decode_prefetch(const uint8_t *input, size_t length, uint32_t *output, size_t distance);
+    // non-temporal (Zihintntl) output stores, for outputs that are consumed much later
+    size_t varint_decode_nt(const uint8_t *input, size_t length, uint32_t *output);
+    size_t varint_rvv_m2(const uint8_t *input, size_t length, uint32_t *output);
+    size_t varint_rvv_m4(const uint8_t *input, size_t length, uint32_t *output);
+    size_t varint_decode_adaptive(const uint8_t *input, size_t length, uint32_t *output);
+
+    // one buffer of a varint_decode_batch call
+    typedef struct varint_batch_entry
+    {
+        const uint8_t *input;
+        size_t length;
+        uint32_t *output;
+        size_t count; // set to the number of decoded integers
+    } varint_batch_entry;
+
+    size_t varint_decode_batch(varint_batch_entry *entries, size_t num_entries);
+    // decodes independent streams (e.g. columns) in lockstep, 2 or 4 per loop iteration
+    size_t varint_decode_multi(varint_batch_entry *streams, size_t num_streams);
+
+    // work of one thread of varint_decode_batch_parallel
+    typedef struct varint_thread_stats
+    {
+        uint64_t busy_ns; // time spent in tasks
+        size_t tasks;
+        size_t steals; // tasks taken from other threads
+    } varint_thread_stats;
+
+    // decodes a batch of uneven buffers on num_threads threads with work stealing, stats may be NULL
+    size_t varint_decode_batch_parallel(varint_batch_entry *entries, size_t num_entries, size_t num_threads, varint_thread_stats *stats);
+
+    size_t varint_decode_scalar_u64(const uint8_t *input, int length, uint64_t *output);
+    size_t vbyte_encode_u64(const uint64_t *in, size_t length, uint8_t *bout);
+    size_t varint_decode_u64(const uint8_t *input, size_t length, uint64_t *output);
+
+    size_t varint_decode_zigzag_s32(const uint8_t *input, size_t length, int32_t *output);
+    size_t varint_decode_zigzag_s64(const uint8_t *input, size_t length, int64_t *output);
+
+    size_t varint_decode_delta_u32(const uint8_t *input, size_t length, uint32_t *output, uint32_t previous);
+    size_t varint_decode_delta_u64(const uint8_t *input, size_t length, uint64_t *output, uint64_t previous);
+
+    varint_status varint_decode_scalar_safe(const uint8_t *input, size_t length, uint32_t *output, size_t *values_written, size_t *bytes_consumed);
+    varint_status varint_decode_vecshift_safe(const uint8_t *input, size_t length, uint32_t *output, size_t *values_written, size_t *bytes_consumed);
+    varint_status varint_decode_u64_safe(const uint8_t *input, size_t length, uint64_t *output, size_t *values_written, size_t *bytes_consumed);
+
+    // decode at most max_values integers, e.g. into a small reused output buffer
+    size_t varint_decode_vecshift_bounded(const uint8_t *input, size_t length, uint32_t *output, size_t max_values, size_t *bytes_consumed);
+    size_t varint_decode_u64_bounded(const uint8_t *input, size_t length, uint64_t *output, size_t max_values, size_t *bytes_consumed);
+
+    // validation without decoding, same checks as the _safe decoders
+    varint_status varint_validate(const uint8_t *input, size_t length);
+    varint_status varint_validate_u64(const uint8_t *input, size_t length);
+
+    // number of varints, optionally with the histogram of their lengths (1-5 bytes)
+    size_t varint_count(const uint8_t *input, size_t length);
+    size_t varint_count_lengths(const uint8_t *input, size_t length, size_t histogram[5]);
+    // byte offset of the k-th varint (counted from 0) without decoding
+    size_t varint_skip(const uint8_t *input, size_t length, size_t k);
+
+    // state of a streaming decoder, the bytes of a varint that continues in the next chunk
+    typedef struct varint_stream
+    {
+        uint64_t pending_value; // payload bits of the pending bytes
+        uint8_t pending_bytes;  // at most 4 (9 for 64-bit) for valid input
+    } varint_stream;
+
+    void varint_stream_init(varint_stream *stream);
+    size_t varint_stream_feed(varint_stream *stream, const uint8_t *input, size_t length, uint32_t *output);
+    size_t varint_stream_feed_u64(varint_stream *stream, const uint8_t *input, size_t length, uint64_t *output);
+    varint_status varint_stream_finish(varint_stream *stream);
+
+    // block-indexed container, see varint_blocks.c for the layout
+#define VARINT_BLOCKS_MINMAX 1
+
+    typedef struct varint_blocks
+    {
+        const uint8_t *index; // block entries
+        const uint8_t *data;  // varints of all blocks
+        size_t data_length;
+        uint32_t value_count;
+        uint32_t block_size;
+        uint32_t block_count;
+        uint32_t flags;
+    } varint_blocks;
+
+    typedef struct varint_block_info
+    {
+        size_t offset; // relative to varint_blocks.data
+        size_t length; // in bytes
+        uint32_t count;
+        uint32_t min; // 0 / UINT32_MAX without VARINT_BLOCKS_MINMAX
+        uint32_t max;
+    } varint_block_info;
+
+    size_t varint_blocks_max_size(size_t length, uint32_t block_size, uint32_t flags);
+    size_t varint_blocks_encode(const uint32_t *in, size_t length, uint32_t block_size, uint32_t flags, uint8_t *out);
+    varint_status varint_blocks_open(varint_blocks *blocks, const uint8_t *container, size_t size);
+    void varint_blocks_info(const varint_blocks *blocks, size_t block, varint_block_info *info);
+    size_t varint_blocks_decode_block(const varint_blocks *blocks, size_t block, uint32_t *output);
+    size_t varint_blocks_decode(const varint_blocks *blocks, uint32_t *output);
+    size_t varint_blocks_decode_range(const varint_blocks *blocks, size_t first, size_t count, uint32_t *output);
+
+    size_t varint_decode_u16(const uint8_t *input, size_t length, uint16_t *output);
+    size_t varint_decode_u8(const uint8_t *input, size_t length, uint8_t *output);
 
 #ifdef __cplusplus
 }
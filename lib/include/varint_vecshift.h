@@ -0,0 +1,450 @@
+#ifndef VARINT_VECSHIFT_H
+#define VARINT_VECSHIFT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <riscv_vector.h>
+
+/**
+ * Register-level building blocks of the vecshift decoders. Each function decodes all complete varints in the
+ * vl bytes of input and returns them in the lowest lanes of the result vector, so decoder variants only differ in
+ * what they do with the decoded lanes before the store.
+ *
+ * num_varints: number of complete varints (valid result lanes)
+ * number_of_bytes: number of input bytes occupied by these varints
+ */
+
+/**
+ * vecshift_decode_u32m4 for callers that already counted the termination bytes of input (count1) and handled the
+ * all 1-byte case (count1 == vl).
+ */
+static inline __attribute__((always_inline)) vuint32m4_t vecshift_decode_counted_u32m4(vuint8m1_t input, size_t vl, size_t count1, size_t *num_varints, size_t *number_of_bytes)
+{
+    *num_varints = count1;
+
+    // inspired by https://github.com/camel-cdr/rvv-bench/blob/main/vector-utf/8toN_gather.c
+    vuint8m1_t v1 = __riscv_vslide1down(input, 0, vl);
+    vuint8m1_t v2 = __riscv_vslide1down(v1, 0, vl);
+
+    // every byte after a termination byte is as first byte
+    vuint8m1_t v_prev = __riscv_vslide1up(input, 0, vl);
+    vbool8_t m_first_bytes = __riscv_vmsleu(v_prev, 0x7F, vl);
+
+    // compress the slided input data vectors with the first_byte mask. That way we get the second, third, fourth and fifth byte after each first byte.
+    vuint8m1_t first_bytes = __riscv_vcompress(input, m_first_bytes, vl);
+    vuint8m1_t second_bytes = __riscv_vcompress(v1, m_first_bytes, vl);
+
+    vbool8_t m_second_bytes = __riscv_vmsgtu(first_bytes, 0x7F, vl);
+    vbool8_t m_third_bytes = __riscv_vmand(m_second_bytes, __riscv_vmsgtu(second_bytes, 0x7F, vl), vl);
+
+    // remove continuation bits (bit 7) from payload bytes
+    vuint8m1_t b1 = __riscv_vand(first_bytes, 0x7F, vl);
+    vuint8m1_t b2 = __riscv_vand(second_bytes, 0x7F, vl);
+
+    // Build result in 16-bit first (fits 14 bits for 2-byte varints)
+    // b1: bits 0-6 b2: bits 7-13 (shift by 7, i.e., multiply by 128)
+    vuint16m2_t result12 = __riscv_vwmaccu_mu(m_second_bytes, __riscv_vzext_vf2(b1, vl), 128, b2, vl);
+
+    // Compute byte counts for each varint length
+    // Use count1 as vl to exclude any incomplete varint at the end
+    size_t count2 = __riscv_vcpop(m_second_bytes, count1);
+    size_t count3 = __riscv_vcpop(m_third_bytes, count1);
+
+    if (count3 == 0)
+    {
+        *number_of_bytes = count1 + count2;
+        return __riscv_vzext_vf2(result12, vl);
+    }
+
+    vuint8m1_t v3 = __riscv_vslide1down(v2, 0, vl);
+    vuint8m1_t v4 = __riscv_vslide1down(v3, 0, vl);
+
+    vuint8m1_t third_bytes = __riscv_vcompress(v2, m_first_bytes, vl);
+    vuint8m1_t fourth_bytes = __riscv_vcompress(v3, m_first_bytes, vl);
+
+    vbool8_t m_fourth_bytes = __riscv_vmand(m_third_bytes, __riscv_vmsgtu(third_bytes, 0x7F, vl), vl);
+    vbool8_t m_fifth_bytes = __riscv_vmand(m_fourth_bytes, __riscv_vmsgtu(fourth_bytes, 0x7F, vl), vl);
+
+    size_t count4 = __riscv_vcpop(m_fourth_bytes, count1);
+    size_t count5 = __riscv_vcpop(m_fifth_bytes, count1);
+
+    // Total bytes = sum of bytes per varint
+    *number_of_bytes = count1 + count2 + count3 + count4 + count5;
+
+    vuint8m1_t b3 = __riscv_vand(third_bytes, 0x7F, vl);
+    vuint8m1_t b4 = __riscv_vand(fourth_bytes, 0x7F, vl);
+
+    // b3: bits 0-6 b4: bits 7-13 (shift by 7, i.e., multiply by 128)
+    vuint16m2_t result34 = __riscv_vwmaccu_mu(m_fourth_bytes, __riscv_vzext_vf2(b3, vl), 128, b4, vl);
+
+    // shift result34 left by 14 (multiply with 16384) and add it to result12
+    vuint32m4_t result1234 = __riscv_vwmaccu_mu(m_third_bytes, __riscv_vzext_vf2(result12, vl), 16384, result34, vl);
+
+    if (count5 > 0)
+    {
+        vuint8m1_t fifth_bytes = __riscv_vcompress(v4, m_first_bytes, vl);
+
+        vuint8m1_t b5 = __riscv_vand(fifth_bytes, 0x7F, vl);
+
+        // b5: bits 28-31 (shift by 28)
+        // vwmaccu cannot be used as the scalar shift value is too large.
+        result1234 = __riscv_vadd_mu(m_fifth_bytes, result1234, result1234, __riscv_vsll(__riscv_vzext_vf4(b5, vl), 28, vl), vl);
+    }
+
+    return result1234;
+}
+
+static inline __attribute__((always_inline)) vuint32m4_t vecshift_decode_u32m4(vuint8m1_t input, size_t vl, size_t *num_varints, size_t *number_of_bytes)
+{
+    // mask set when element has termination bit (MSB==0) set
+    vbool8_t termination_mask = __riscv_vmsleu(input, 0x7F, vl);
+
+    // popcount on termination mask tells us number of complete varints in register, as bytes with termination bit set are at the last position in a varint.
+    size_t count1 = __riscv_vcpop(termination_mask, vl);
+
+    // fast path. No continuation bits (MSB==1) set
+    if (count1 == vl)
+    {
+        *num_varints = vl;
+        *number_of_bytes = vl;
+
+        // expand every byte to 32-bit lane
+        return __riscv_vzext_vf4(input, vl);
+    }
+
+    return vecshift_decode_counted_u32m4(input, vl, count1, num_varints, number_of_bytes);
+}
+
+/**
+ * vecshift_decode_u32m4 with additional fast paths for registers that hold only 2-byte or only 3-byte varints, e.g.
+ * columns of small deltas. Such registers are recognized by the number of termination bytes (vl / 2 or vl / 3) and
+ * confirmed by the continuation bits of every varint, both kernels need no vcompress:
+ * - 2 bytes: every 16-bit lane holds one varint, vnsrl at e16 splits it into its first and second bytes
+ * - 3 bytes: a segment load (vlseg3e8) of data deinterleaves the first, second and third bytes of all varints
+ * The termination bytes are counted once, other registers continue in vecshift_decode_counted_u32m4.
+ *
+ * data: memory the vl bytes of input were loaded from
+ */
+static inline __attribute__((always_inline)) vuint32m4_t vecshift_decode_uniform_u32m4(const uint8_t *data, vuint8m1_t input, size_t vl, size_t *num_varints, size_t *number_of_bytes)
+{
+    size_t count1 = __riscv_vcpop(__riscv_vmsleu(input, 0x7F, vl), vl);
+
+    *num_varints = count1;
+
+    if (count1 == vl)
+    {
+        *number_of_bytes = vl;
+        return __riscv_vzext_vf4(input, vl);
+    }
+
+    if (count1 > 0 && count1 == vl / 2)
+    {
+        // little-endian: first byte in bits 0-7 with the continuation bit set, second byte in bits 8-15 without
+        vuint16m1_t pairs = __riscv_vreinterpret_v_u8m1_u16m1(input);
+        vbool16_t m_other = __riscv_vmsne(__riscv_vand(pairs, 0x8080, count1), 0x0080, count1);
+
+        if (__riscv_vfirst(m_other, count1) < 0)
+        {
+            vuint8mf2_t b1 = __riscv_vand(__riscv_vnsrl(pairs, 0, count1), 0x7F, count1);
+            vuint8mf2_t b2 = __riscv_vnsrl(pairs, 8, count1);
+
+            vuint16m1_t result12 = __riscv_vwmaccu(__riscv_vzext_vf2(b1, count1), 128, b2, count1);
+
+            *number_of_bytes = 2 * count1;
+            return __riscv_vlmul_ext_v_u32m2_u32m4(__riscv_vzext_vf2(result12, count1));
+        }
+    }
+    else if (count1 > 0 && count1 == vl / 3)
+    {
+        vuint8m1x3_t segments = __riscv_vlseg3e8_v_u8m1x3(data, count1);
+        vuint8m1_t first_bytes = __riscv_vget_v_u8m1x3_u8m1(segments, 0);
+        vuint8m1_t second_bytes = __riscv_vget_v_u8m1x3_u8m1(segments, 1);
+        vuint8m1_t third_bytes = __riscv_vget_v_u8m1x3_u8m1(segments, 2);
+
+        vbool8_t m_other = __riscv_vmor(__riscv_vmor(__riscv_vmsleu(first_bytes, 0x7F, count1), __riscv_vmsleu(second_bytes, 0x7F, count1), count1),
+                                        __riscv_vmsgtu(third_bytes, 0x7F, count1), count1);
+
+        if (__riscv_vfirst(m_other, count1) < 0)
+        {
+            vuint8m1_t b1 = __riscv_vand(first_bytes, 0x7F, count1);
+            vuint8m1_t b2 = __riscv_vand(second_bytes, 0x7F, count1);
+
+            vuint16m2_t result12 = __riscv_vwmaccu(__riscv_vzext_vf2(b1, count1), 128, b2, count1);
+
+            *number_of_bytes = 3 * count1;
+            return __riscv_vwmaccu(__riscv_vzext_vf2(result12, count1), 16384, __riscv_vzext_vf2(third_bytes, count1), count1);
+        }
+    }
+
+    return vecshift_decode_counted_u32m4(input, vl, count1, num_varints, number_of_bytes);
+}
+
+// LMUL=2 variant of vecshift_decode_u32m4, the result occupies a full e32/m8 register group
+static inline __attribute__((always_inline)) vuint32m8_t vecshift_decode_u32m8(vuint8m2_t input, size_t vl, size_t *num_varints, size_t *number_of_bytes)
+{
+    // mask set when element has termination bit (MSB==0) set
+    vbool4_t termination_mask = __riscv_vmsleu(input, 0x7F, vl);
+
+    size_t count1 = __riscv_vcpop(termination_mask, vl);
+    *num_varints = count1;
+
+    // fast path. No continuation bits (MSB==1) set
+    if (count1 == vl)
+    {
+        *number_of_bytes = vl;
+
+        // expand every byte to 32-bit lane
+        return __riscv_vzext_vf4(input, vl);
+    }
+
+    vuint8m2_t v1 = __riscv_vslide1down(input, 0, vl);
+    vuint8m2_t v2 = __riscv_vslide1down(v1, 0, vl);
+
+    // every byte after a termination byte is as first byte
+    vuint8m2_t v_prev = __riscv_vslide1up(input, 0, vl);
+    vbool4_t m_first_bytes = __riscv_vmsleu(v_prev, 0x7F, vl);
+
+    vuint8m2_t first_bytes = __riscv_vcompress(input, m_first_bytes, vl);
+    vuint8m2_t second_bytes = __riscv_vcompress(v1, m_first_bytes, vl);
+
+    vbool4_t m_second_bytes = __riscv_vmsgtu(first_bytes, 0x7F, vl);
+    vbool4_t m_third_bytes = __riscv_vmand(m_second_bytes, __riscv_vmsgtu(second_bytes, 0x7F, vl), vl);
+
+    // remove continuation bits (bit 7) from payload bytes
+    vuint8m2_t b1 = __riscv_vand(first_bytes, 0x7F, vl);
+    vuint8m2_t b2 = __riscv_vand(second_bytes, 0x7F, vl);
+
+    // Build result in 16-bit first (fits 14 bits for 2-byte varints)
+    // b1: bits 0-6 b2: bits 7-13 (shift by 7, i.e., multiply by 128)
+    vuint16m4_t result12 = __riscv_vwmaccu_mu(m_second_bytes, __riscv_vzext_vf2(b1, vl), 128, b2, vl);
+
+    // Compute byte counts for each varint length
+    // Use count1 as vl to exclude any incomplete varint at the end
+    size_t count2 = __riscv_vcpop(m_second_bytes, count1);
+    size_t count3 = __riscv_vcpop(m_third_bytes, count1);
+
+    if (count3 == 0)
+    {
+        *number_of_bytes = count1 + count2;
+        return __riscv_vzext_vf2(result12, vl);
+    }
+
+    vuint8m2_t v3 = __riscv_vslide1down(v2, 0, vl);
+    vuint8m2_t v4 = __riscv_vslide1down(v3, 0, vl);
+
+    vuint8m2_t third_bytes = __riscv_vcompress(v2, m_first_bytes, vl);
+    vuint8m2_t fourth_bytes = __riscv_vcompress(v3, m_first_bytes, vl);
+
+    vbool4_t m_fourth_bytes = __riscv_vmand(m_third_bytes, __riscv_vmsgtu(third_bytes, 0x7F, vl), vl);
+    vbool4_t m_fifth_bytes = __riscv_vmand(m_fourth_bytes, __riscv_vmsgtu(fourth_bytes, 0x7F, vl), vl);
+
+    size_t count4 = __riscv_vcpop(m_fourth_bytes, count1);
+    size_t count5 = __riscv_vcpop(m_fifth_bytes, count1);
+
+    // Total bytes = sum of bytes per varint
+    *number_of_bytes = count1 + count2 + count3 + count4 + count5;
+
+    vuint8m2_t b3 = __riscv_vand(third_bytes, 0x7F, vl);
+    vuint8m2_t b4 = __riscv_vand(fourth_bytes, 0x7F, vl);
+
+    // b3: bits 0-6 b4: bits 7-13 (shift by 7, i.e., multiply by 128)
+    vuint16m4_t result34 = __riscv_vwmaccu_mu(m_fourth_bytes, __riscv_vzext_vf2(b3, vl), 128, b4, vl);
+
+    // shift result34 left by 14 (multiply with 16384) and add it to result12
+    vuint32m8_t result1234 = __riscv_vwmaccu_mu(m_third_bytes, __riscv_vzext_vf2(result12, vl), 16384, result34, vl);
+
+    if (count5 > 0)
+    {
+        vuint8m2_t fifth_bytes = __riscv_vcompress(v4, m_first_bytes, vl);
+
+        vuint8m2_t b5 = __riscv_vand(fifth_bytes, 0x7F, vl);
+
+        // b5: bits 28-31 (shift by 28)
+        // vwmaccu cannot be used as the scalar shift value is too large.
+        result1234 = __riscv_vadd_mu(m_fifth_bytes, result1234, result1234, __riscv_vsll(__riscv_vzext_vf4(b5, vl), 28, vl), vl);
+    }
+
+    return result1234;
+}
+
+static inline __attribute__((always_inline)) vuint64m8_t vecshift_decode_u64m8(vuint8m1_t input, size_t vl, size_t *num_varints, size_t *number_of_bytes)
+{
+    vbool8_t termination_mask = __riscv_vmsleu(input, 0x7F, vl);
+
+    size_t count1 = __riscv_vcpop(termination_mask, vl);
+    *num_varints = count1;
+
+    // fast path. No continuation bits (MSB==1) set
+    if (count1 == vl)
+    {
+        *number_of_bytes = vl;
+
+        // expand every byte to 64-bit lane
+        return __riscv_vzext_vf8(input, vl);
+    }
+
+    vuint8m1_t v1 = __riscv_vslide1down(input, 0, vl);
+    vuint8m1_t v2 = __riscv_vslide1down(v1, 0, vl);
+
+    // every byte after a termination byte is as first byte
+    vuint8m1_t v_prev = __riscv_vslide1up(input, 0, vl);
+    vbool8_t m_first_bytes = __riscv_vmsleu(v_prev, 0x7F, vl);
+
+    vuint8m1_t first_bytes = __riscv_vcompress(input, m_first_bytes, vl);
+    vuint8m1_t second_bytes = __riscv_vcompress(v1, m_first_bytes, vl);
+
+    vbool8_t m_second_bytes = __riscv_vmsgtu(first_bytes, 0x7F, vl);
+    vbool8_t m_third_bytes = __riscv_vmand(m_second_bytes, __riscv_vmsgtu(second_bytes, 0x7F, vl), vl);
+
+    // remove continuation bits (bit 7) from payload bytes
+    vuint8m1_t b1 = __riscv_vand(first_bytes, 0x7F, vl);
+    vuint8m1_t b2 = __riscv_vand(second_bytes, 0x7F, vl);
+
+    // b1: bits 0-6 b2: bits 7-13 (shift by 7, i.e., multiply by 128)
+    vuint16m2_t result12 = __riscv_vwmaccu_mu(m_second_bytes, __riscv_vzext_vf2(b1, vl), 128, b2, vl);
+
+    // Use count1 as vl to exclude any incomplete varint at the end
+    size_t count2 = __riscv_vcpop(m_second_bytes, count1);
+    size_t count3 = __riscv_vcpop(m_third_bytes, count1);
+
+    if (count3 == 0)
+    {
+        *number_of_bytes = count1 + count2;
+        return __riscv_vzext_vf4(result12, vl);
+    }
+
+    vuint8m1_t v3 = __riscv_vslide1down(v2, 0, vl);
+    vuint8m1_t v4 = __riscv_vslide1down(v3, 0, vl);
+
+    vuint8m1_t third_bytes = __riscv_vcompress(v2, m_first_bytes, vl);
+    vuint8m1_t fourth_bytes = __riscv_vcompress(v3, m_first_bytes, vl);
+
+    vbool8_t m_fourth_bytes = __riscv_vmand(m_third_bytes, __riscv_vmsgtu(third_bytes, 0x7F, vl), vl);
+    vbool8_t m_fifth_bytes = __riscv_vmand(m_fourth_bytes, __riscv_vmsgtu(fourth_bytes, 0x7F, vl), vl);
+
+    size_t count4 = __riscv_vcpop(m_fourth_bytes, count1);
+    size_t count5 = __riscv_vcpop(m_fifth_bytes, count1);
+
+    vuint8m1_t b3 = __riscv_vand(third_bytes, 0x7F, vl);
+    vuint8m1_t b4 = __riscv_vand(fourth_bytes, 0x7F, vl);
+
+    // b3: bits 0-6 b4: bits 7-13 (shift by 7, i.e., multiply by 128)
+    vuint16m2_t result34 = __riscv_vwmaccu_mu(m_fourth_bytes, __riscv_vzext_vf2(b3, vl), 128, b4, vl);
+
+    // shift result34 left by 14 (multiply with 16384) and add it to result12
+    vuint32m4_t result1234 = __riscv_vwmaccu_mu(m_third_bytes, __riscv_vzext_vf2(result12, vl), 16384, result34, vl);
+
+    // short values: no varint in this register is longer than 4 bytes (28 bits)
+    if (count5 == 0)
+    {
+        *number_of_bytes = count1 + count2 + count3 + count4;
+        return __riscv_vzext_vf2(result1234, vl);
+    }
+
+    // bytes 5-8 are combined exactly like bytes 1-4 and form bits 28-55
+    vuint8m1_t v5 = __riscv_vslide1down(v4, 0, vl);
+    vuint8m1_t v6 = __riscv_vslide1down(v5, 0, vl);
+    vuint8m1_t v7 = __riscv_vslide1down(v6, 0, vl);
+
+    vuint8m1_t fifth_bytes = __riscv_vcompress(v4, m_first_bytes, vl);
+    vuint8m1_t sixth_bytes = __riscv_vcompress(v5, m_first_bytes, vl);
+    vuint8m1_t seventh_bytes = __riscv_vcompress(v6, m_first_bytes, vl);
+    vuint8m1_t eighth_bytes = __riscv_vcompress(v7, m_first_bytes, vl);
+
+    vbool8_t m_sixth_bytes = __riscv_vmand(m_fifth_bytes, __riscv_vmsgtu(fifth_bytes, 0x7F, vl), vl);
+    vbool8_t m_seventh_bytes = __riscv_vmand(m_sixth_bytes, __riscv_vmsgtu(sixth_bytes, 0x7F, vl), vl);
+    vbool8_t m_eighth_bytes = __riscv_vmand(m_seventh_bytes, __riscv_vmsgtu(seventh_bytes, 0x7F, vl), vl);
+    vbool8_t m_ninth_bytes = __riscv_vmand(m_eighth_bytes, __riscv_vmsgtu(eighth_bytes, 0x7F, vl), vl);
+
+    size_t count6 = __riscv_vcpop(m_sixth_bytes, count1);
+    size_t count7 = __riscv_vcpop(m_seventh_bytes, count1);
+    size_t count8 = __riscv_vcpop(m_eighth_bytes, count1);
+    size_t count9 = __riscv_vcpop(m_ninth_bytes, count1);
+
+    *number_of_bytes = count1 + count2 + count3 + count4 + count5 + count6 + count7 + count8;
+
+    vuint8m1_t b5 = __riscv_vand(fifth_bytes, 0x7F, vl);
+    vuint8m1_t b6 = __riscv_vand(sixth_bytes, 0x7F, vl);
+    vuint8m1_t b7 = __riscv_vand(seventh_bytes, 0x7F, vl);
+    vuint8m1_t b8 = __riscv_vand(eighth_bytes, 0x7F, vl);
+
+    vuint16m2_t result56 = __riscv_vwmaccu_mu(m_sixth_bytes, __riscv_vzext_vf2(b5, vl), 128, b6, vl);
+    vuint16m2_t result78 = __riscv_vwmaccu_mu(m_eighth_bytes, __riscv_vzext_vf2(b7, vl), 128, b8, vl);
+    vuint32m4_t result5678 = __riscv_vwmaccu_mu(m_seventh_bytes, __riscv_vzext_vf2(result56, vl), 16384, result78, vl);
+
+    // shift result5678 left by 28 and add it to the low 28 bits
+    vuint64m8_t result = __riscv_vwmaccu_mu(m_fifth_bytes, __riscv_vzext_vf2(result1234, vl), 1U << 28, result5678, vl);
+
+    if (count9 > 0)
+    {
+        vuint8m1_t v8 = __riscv_vslide1down(v7, 0, vl);
+        vuint8m1_t v9 = __riscv_vslide1down(v8, 0, vl);
+
+        vuint8m1_t ninth_bytes = __riscv_vcompress(v8, m_first_bytes, vl);
+        vuint8m1_t tenth_bytes = __riscv_vcompress(v9, m_first_bytes, vl);
+
+        vbool8_t m_tenth_bytes = __riscv_vmand(m_ninth_bytes, __riscv_vmsgtu(ninth_bytes, 0x7F, vl), vl);
+
+        *number_of_bytes += count9 + __riscv_vcpop(m_tenth_bytes, count1);
+
+        // b9: bits 56-62, only the lowest bit of b10 is left for bit 63
+        vuint8m1_t b9 = __riscv_vand(ninth_bytes, 0x7F, vl);
+        vuint8m1_t b910 = __riscv_vor_mu(m_tenth_bytes, b9, b9, __riscv_vsll(tenth_bytes, 7, vl), vl);
+
+        result = __riscv_vor_mu(m_ninth_bytes, result, result, __riscv_vsll(__riscv_vzext_vf8(b910, vl), 56, vl), vl);
+    }
+
+    return result;
+}
+
+/**
+ * Marks the bytes that make a 32-bit varint invalid: a byte preceded by four continuation bytes is the fifth byte
+ * of a varint, it must neither continue (overlong, more than 5 bytes) nor carry payload bits above bit 31 (overflow,
+ * value > 0x0F). input has to start at a varint boundary. The first marked byte is the fifth byte of the first
+ * invalid varint, its continuation bit tells both errors apart.
+ */
+static inline __attribute__((always_inline)) vbool8_t vecshift_error_mask_u32(vuint8m1_t input, size_t vl)
+{
+    vuint8m1_t zero = __riscv_vmv_v_x_u8m1(0, vl);
+
+    // AND of the previous 1, 2 and 4 bytes, the MSB is set if all of them are continuation bytes
+    vuint8m1_t prev1 = __riscv_vslide1up(input, 0, vl);
+    vuint8m1_t prev2 = __riscv_vand(prev1, __riscv_vslideup(zero, prev1, 1, vl), vl);
+    vuint8m1_t prev4 = __riscv_vand(prev2, __riscv_vslideup(zero, prev2, 2, vl), vl);
+
+    return __riscv_vmand(__riscv_vmsgtu(prev4, 0x7F, vl), __riscv_vmsgtu(input, 0x0F, vl), vl);
+}
+
+/**
+ * 64-bit variant of vecshift_error_mask_u32: marks the tenth byte of a varint if it continues (overlong, more than
+ * 10 bytes) or has payload bits above bit 63 set (overflow, value > 0x01).
+ */
+static inline __attribute__((always_inline)) vbool8_t vecshift_error_mask_u64(vuint8m1_t input, size_t vl)
+{
+    vuint8m1_t zero = __riscv_vmv_v_x_u8m1(0, vl);
+
+    vuint8m1_t prev1 = __riscv_vslide1up(input, 0, vl);
+    vuint8m1_t prev2 = __riscv_vand(prev1, __riscv_vslideup(zero, prev1, 1, vl), vl);
+    vuint8m1_t prev4 = __riscv_vand(prev2, __riscv_vslideup(zero, prev2, 2, vl), vl);
+    vuint8m1_t prev8 = __riscv_vand(prev4, __riscv_vslideup(zero, prev4, 4, vl), vl);
+    vuint8m1_t prev9 = __riscv_vand(prev8, __riscv_vslideup(zero, prev1, 8, vl), vl);
+
+    return __riscv_vmand(__riscv_vmsgtu(prev9, 0x7F, vl), __riscv_vmsgtu(input, 0x01, vl), vl);
+}
+
+/**
+ * Shortens vl so that the input ends after the max_varints-th termination byte, if the register holds more varints.
+ * returns: new vl, the register then holds at most max_varints complete varints
+ */
+static inline __attribute__((always_inline)) size_t vecshift_limit_vl(vuint8m1_t input, size_t vl, size_t max_varints)
+{
+    vbool8_t terminations = __riscv_vmsleu(input, 0x7F, vl);
+
+    // number of termination bytes in front of each byte, e16 lanes so that any VLEN works
+    vuint16m2_t index = __riscv_viota_m_u16m2(terminations, vl);
+    long cut = __riscv_vfirst(__riscv_vmand(terminations, __riscv_vmsgeu(index, max_varints, vl), vl), vl);
+
+    return cut < 0 ? vl : (size_t)cut;
+}
+
+#endif // VARINT_VECSHIFT_H
@@ -0,0 +1,218 @@
+#include "libvarintrvv.h"
+
+#include <string.h>
+
+/**
+ * Block-indexed container for large varint columns. The values are split into blocks of block_size values that
+ * are encoded with vbyte_encode and stored back to back, so every block starts at a varint boundary and can be
+ * decoded on its own. A fixed size index in front of the data holds the byte offset and value count of every block,
+ * optionally with the minimum and maximum value for skipping blocks by value.
+ *
+ * Layout, all fields are little-endian uint32_t:
+ *   header:  value_count, block_size, block_count, flags
+ *   index:   block_count entries of offset, count (, min, max if flags & VARINT_BLOCKS_MINMAX)
+ *   data:    varints of all blocks, offsets are relative to the start of the data
+ */
+
+#define BLOCKS_HEADER_SIZE (4 * sizeof(uint32_t))
+
+static inline size_t blocks_entry_size(uint32_t flags)
+{
+    return (flags & VARINT_BLOCKS_MINMAX ? 4 : 2) * sizeof(uint32_t);
+}
+
+static inline void blocks_store(uint8_t *out, uint32_t value)
+{
+    memcpy(out, &value, sizeof(value));
+}
+
+static inline uint32_t blocks_load(const uint8_t *in)
+{
+    uint32_t value;
+    memcpy(&value, in, sizeof(value));
+    return value;
+}
+
+/**
+ * returns: upper bound of the container size for length values, for allocating the output of varint_blocks_encode,
+ *          0 if block_size is 0
+ */
+size_t varint_blocks_max_size(size_t length, uint32_t block_size, uint32_t flags)
+{
+    if (block_size == 0)
+    {
+        return 0;
+    }
+
+    size_t block_count = (length + block_size - 1) / block_size;
+    return BLOCKS_HEADER_SIZE + block_count * blocks_entry_size(flags) + length * 5;
+}
+
+/**
+ * in: values to encode, at most UINT32_MAX values with less than 4 GB of varints
+ * block_size: number of values per block, all blocks but the last one are full
+ * flags: VARINT_BLOCKS_MINMAX to store the minimum and maximum value of every block
+ * returns: size of the container in bytes, 0 if block_size is 0
+ */
+size_t varint_blocks_encode(const uint32_t *in, size_t length, uint32_t block_size, uint32_t flags, uint8_t *out)
+{
+    if (block_size == 0)
+    {
+        return 0;
+    }
+
+    const uint32_t block_count = (uint32_t)((length + block_size - 1) / block_size);
+    const size_t entry_size = blocks_entry_size(flags);
+
+    blocks_store(out, (uint32_t)length);
+    blocks_store(out + 4, block_size);
+    blocks_store(out + 8, block_count);
+    blocks_store(out + 12, flags);
+
+    uint8_t *entry = out + BLOCKS_HEADER_SIZE;
+    uint8_t *data = entry + block_count * entry_size;
+    size_t offset = 0;
+
+    for (size_t first = 0; first < length; first += block_size)
+    {
+        uint32_t count = length - first < block_size ? (uint32_t)(length - first) : block_size;
+
+        blocks_store(entry, (uint32_t)offset);
+        blocks_store(entry + 4, count);
+
+        if (flags & VARINT_BLOCKS_MINMAX)
+        {
+            uint32_t min = in[first], max = in[first];
+            for (size_t i = first + 1; i < first + count; i++)
+            {
+                min = in[i] < min ? in[i] : min;
+                max = in[i] > max ? in[i] : max;
+            }
+            blocks_store(entry + 8, min);
+            blocks_store(entry + 12, max);
+        }
+
+        offset += vbyte_encode(in + first, count, data + offset);
+        entry += entry_size;
+    }
+
+    return (size_t)(data - out) + offset;
+}
+
+/**
+ * Reads the header of a container, the container has to stay valid while blocks refers to it. Header and index are
+ * checked, so that the decoders stay within the container, the varints themselves are not validated.
+ * returns: VARINT_TRUNCATED if size is smaller than header and index, VARINT_CORRUPT if the block count does not
+ *          match value count and block size, the offsets are not ascending within the data or a block
+ *          count exceeds the block size, VARINT_OK otherwise
+ */
+varint_status varint_blocks_open(varint_blocks *blocks, const uint8_t *container, size_t size)
+{
+    if (size < BLOCKS_HEADER_SIZE)
+    {
+        return VARINT_TRUNCATED;
+    }
+
+    blocks->value_count = blocks_load(container);
+    blocks->block_size = blocks_load(container + 4);
+    blocks->block_count = blocks_load(container + 8);
+    blocks->flags = blocks_load(container + 12);
+
+    size_t index_size = (size_t)blocks->block_count * blocks_entry_size(blocks->flags);
+    if (size - BLOCKS_HEADER_SIZE < index_size)
+    {
+        return VARINT_TRUNCATED;
+    }
+
+    if (blocks->block_size == 0 ? blocks->value_count > 0 || blocks->block_count > 0
+                                : blocks->block_count != (blocks->value_count + (uint64_t)blocks->block_size - 1) / blocks->block_size)
+    {
+        return VARINT_CORRUPT;
+    }
+
+    blocks->index = container + BLOCKS_HEADER_SIZE;
+    blocks->data = blocks->index + index_size;
+    blocks->data_length = size - BLOCKS_HEADER_SIZE - index_size;
+
+    const size_t entry_size = blocks_entry_size(blocks->flags);
+    size_t previous = 0;
+    for (size_t block = 0; block < blocks->block_count; block++)
+    {
+        const uint8_t *entry = blocks->index + block * entry_size;
+        size_t offset = blocks_load(entry);
+        if (offset < previous || offset > blocks->data_length || blocks_load(entry + 4) > blocks->block_size)
+        {
+            return VARINT_CORRUPT;
+        }
+        previous = offset;
+    }
+    return VARINT_OK;
+}
+
+/**
+ * Reads the index entry of a block.
+ * info: offset of the block in the data, its length in bytes, value count and, if stored, minimum and maximum
+ */
+void varint_blocks_info(const varint_blocks *blocks, size_t block, varint_block_info *info)
+{
+    const size_t entry_size = blocks_entry_size(blocks->flags);
+    const uint8_t *entry = blocks->index + block * entry_size;
+
+    info->offset = blocks_load(entry);
+    info->count = blocks_load(entry + 4);
+    info->min = 0;
+    info->max = UINT32_MAX;
+    if (blocks->flags & VARINT_BLOCKS_MINMAX)
+    {
+        info->min = blocks_load(entry + 8);
+        info->max = blocks_load(entry + 12);
+    }
+
+    size_t end = block + 1 < blocks->block_count ? blocks_load(entry + entry_size) : blocks->data_length;
+    info->length = end - info->offset;
+}
+
+/**
+ * output: decompressed integers of the block, at most block_size
+ * returns: number of decompressed integers
+ */
+size_t varint_blocks_decode_block(const varint_blocks *blocks, size_t block, uint32_t *output)
+{
+    varint_block_info info;
+    varint_blocks_info(blocks, block, &info);
+
+    size_t bytes_consumed;
+    return varint_decode_vecshift_bounded(blocks->data + info.offset, info.length, output, info.count, &bytes_consumed);
+}
+
+/**
+ * output: all value_count integers of the container
+ * returns: number of decompressed integers
+ */
+size_t varint_blocks_decode(const varint_blocks *blocks, uint32_t *output)
+{
+    size_t bytes_consumed;
+    return varint_decode_vecshift_bounded(blocks->data, blocks->data_length, output, blocks->value_count, &bytes_consumed);
+}
+
+/**
+ * Decodes count integers starting with the integer at index first. Only the block that holds the first integer is
+ * searched (varint_skip), decoding then continues across block boundaries.
+ * returns: number of decompressed integers, less than count if the container ends first
+ */
+size_t varint_blocks_decode_range(const varint_blocks *blocks, size_t first, size_t count, uint32_t *output)
+{
+    if (first >= blocks->value_count)
+    {
+        return 0;
+    }
+
+    varint_block_info info;
+    varint_blocks_info(blocks, first / blocks->block_size, &info);
+
+    const uint8_t *block_data = blocks->data + info.offset;
+    size_t start = info.offset + varint_skip(block_data, info.length, first % blocks->block_size);
+
+    size_t bytes_consumed;
+    return varint_decode_vecshift_bounded(blocks->data + start, blocks->data_length - start, output, count, &bytes_consumed);
+}
@@ -0,0 +1,134 @@
+#include "libvarintrvv.h"
+
+/**
+ * Every varint ends in exactly one termination byte (MSB clear), so the number of varints is the popcount of the
+ * termination mask. Both functions only compare and count at LMUL=8, nothing is decoded or stored. A varint that is
+ * truncated at the end of the input is not counted, like in the decoders.
+ */
+
+/**
+ * input: uint8_t pointer to the start of the compressed varints
+ * length: size of the varints in bytes
+ * returns: number of varints, i.e. the number of integers the decoders write
+ */
+size_t varint_count(const uint8_t *input, size_t length)
+{
+    size_t count = 0;
+
+    size_t vl;
+
+    for (size_t pos = 0; pos < length; pos += vl)
+    {
+        vl = __riscv_vsetvl_e8m8(length - pos);
+
+        vbool1_t terminations = __riscv_vmsleu_vx_u8m8_b1(__riscv_vle8_v_u8m8(input + pos, vl), 0x7F, vl);
+        count += __riscv_vcpop_m_b1(terminations, vl);
+    }
+    return count;
+}
+
+/**
+ * Counts the varints and their lengths in one pass. A varint is longer than k bytes if its termination byte follows
+ * k continuation bytes, these bytes are read with unaligned loads at offsets -1 to -4 like in varint_validate.
+ *
+ * histogram: histogram[k] receives the number of varints with k + 1 bytes, longer varints are counted in histogram[4]
+ * returns: number of varints
+ */
+size_t varint_count_lengths(const uint8_t *input, size_t length, size_t histogram[5])
+{
+    // longer_than[k]: number of varints with more than k bytes
+    size_t longer_than[5] = {0};
+
+    // the first 4 bytes have less than 4 bytes in front of them
+    size_t head = length < 4 ? length : 4;
+    for (size_t pos = 0; pos < head; pos++)
+    {
+        if (input[pos] > 0x7F)
+        {
+            continue;
+        }
+        longer_than[0]++;
+        for (size_t back = 1; back <= pos && input[pos - back] > 0x7F; back++)
+        {
+            longer_than[back]++;
+        }
+    }
+
+    size_t vl;
+
+    for (size_t pos = 4; pos < length; pos += vl)
+    {
+        vl = __riscv_vsetvl_e8m8(length - pos);
+        const uint8_t *data = input + pos;
+
+        vbool1_t longer = __riscv_vmsleu_vx_u8m8_b1(__riscv_vle8_v_u8m8(data, vl), 0x7F, vl);
+        longer_than[0] += __riscv_vcpop_m_b1(longer, vl);
+
+        for (size_t back = 1; back <= 4; back++)
+        {
+            vbool1_t continuation = __riscv_vmsgtu_vx_u8m8_b1(__riscv_vle8_v_u8m8(data - back, vl), 0x7F, vl);
+            longer = __riscv_vmand_mm_b1(longer, continuation, vl);
+            longer_than[back] += __riscv_vcpop_m_b1(longer, vl);
+        }
+    }
+
+    for (size_t k = 0; k < 4; k++)
+    {
+        histogram[k] = longer_than[k] - longer_than[k + 1];
+    }
+    histogram[4] = longer_than[4];
+
+    return longer_than[0];
+}
+
+/**
+ * Locates a varint without decoding: whole LMUL=8 blocks are skipped by their termination byte count, the block
+ * that holds the varint is searched in m1 registers and the position is found in the register with viota + vfirst.
+ *
+ * k: index of the varint, counted from 0
+ * returns: byte offset of the k-th varint, length if the input holds k or fewer varints
+ */
+size_t varint_skip(const uint8_t *input, size_t length, size_t k)
+{
+    size_t pos = 0;
+
+    size_t vl;
+
+    if (k == 0)
+    {
+        return 0;
+    }
+
+    // from here on k is the number of varints in front of the wanted one that still have to be skipped
+    while (pos < length)
+    {
+        vl = __riscv_vsetvl_e8m8(length - pos);
+
+        vbool1_t terminations = __riscv_vmsleu_vx_u8m8_b1(__riscv_vle8_v_u8m8(input + pos, vl), 0x7F, vl);
+        size_t count = __riscv_vcpop_m_b1(terminations, vl);
+        if (count >= k)
+        {
+            break;
+        }
+        k -= count;
+        pos += vl;
+    }
+
+    while (pos < length)
+    {
+        vl = __riscv_vsetvl_e8m1(length - pos);
+
+        vbool8_t terminations = __riscv_vmsleu_vx_u8m1_b8(__riscv_vle8_v_u8m1(input + pos, vl), 0x7F, vl);
+        size_t count = __riscv_vcpop_m_b8(terminations, vl);
+        if (count >= k)
+        {
+            // first byte with k termination bytes in front of it, e16 lanes so that any VLEN works
+            vuint16m2_t index = __riscv_viota_m_u16m2(terminations, vl);
+            long offset = __riscv_vfirst_m_b8(__riscv_vmsgeu_vx_u16m2_b8(index, k, vl), vl);
+            return pos + (offset < 0 ? vl : (size_t)offset);
+        }
+        k -= count;
+        pos += vl;
+    }
+    return length;
+}
@@ -0,0 +1,74 @@
+#include "libvarintrvv.h"
+
+/**
+ * Adaptive decoder for streams whose length distribution changes over time. The input is decoded in blocks that
+ * end on a varint boundary. Every block tells how many varints it held, i.e. the sum of the vcpop results on the
+ * termination masks, so the share of continuation bytes is known without an extra pass over the data.
+ *
+ * Blocks with few continuation bytes are decoded with varint_decode, i.e. the fastest kernel for the core
+ * (varint_rvv with V), so dense streams only pay the block loop on top of plain varint_decode. Blocks with many
+ * multi-byte varints are decoded faster by the table based varint_decode_masked_vbyte. The density is smoothed
+ * over blocks and the kernel only changes when it leaves the band between the two thresholds, so streams close
+ * to one threshold do not switch back and forth on every block.
+ */
+
+#define ADAPTIVE_BLOCK_SIZE 1024
+
+// continuation bytes per 256 input bytes
+#define ADAPTIVE_DENSITY_MASKED 128
+#define ADAPTIVE_DENSITY_DISPATCH 80
+
+/**
+ * input: uint8_t pointer to the start of the compressed varints
+ * output: decompressed 32-bit integers
+ * length: size of the varints in bytes
+ * returns: number of decompressed integers
+ */
+size_t varint_decode_adaptive(const uint8_t *data, size_t length, uint32_t *output)
+{
+    size_t processed = 0;
+
+    int use_masked_vbyte = 0;
+    size_t density = 0;
+
+    while (length > 0)
+    {
+        size_t block = length;
+
+        if (length > ADAPTIVE_BLOCK_SIZE)
+        {
+            // cut the block after the last termination byte, so both kernels only see complete varints
+            block = ADAPTIVE_BLOCK_SIZE;
+            while (block > 0 && data[block - 1] > 0x7F)
+            {
+                block--;
+            }
+            if (block == 0)
+            {
+                block = length;
+            }
+        }
+
+        size_t num_varints = use_masked_vbyte ? varint_decode_masked_vbyte(data, block, output)
+                                              : varint_decode(data, block, output);
+
+        // exponential moving average of the continuation byte density, weight 1/4 for the current block
+        size_t block_density = (block - num_varints) * 256 / block;
+        density = (3 * density + block_density) / 4;
+
+        if (!use_masked_vbyte && density > ADAPTIVE_DENSITY_MASKED)
+        {
+            use_masked_vbyte = 1;
+        }
+        else if (use_masked_vbyte && density < ADAPTIVE_DENSITY_DISPATCH)
+        {
+            use_masked_vbyte = 0;
+        }
+
+        data += block;
+        length -= block;
+        output += num_varints;
+        processed += num_varints;
+    }
+    return processed;
+}
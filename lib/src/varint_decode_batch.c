@@ -0,0 +1,96 @@
+#include "libvarintrvv.h"
+#include "varint_vecshift.h"
+
+/**
+ * Decodes many small independent buffers in one call. Buffers that end on a termination byte are complete, so
+ * several of them can be concatenated in one e8/m2 register (vle8 + vslideup) and decoded with a single run of the
+ * vecshift kernel. The number of varints of each buffer is the vcpop of its termination bytes, which tells which
+ * result lanes belong to which output. Buffers that do not fit into a register are decoded with varint_decode,
+ * truncated buffers with varint_decode_vecshift_bounded, which drops the incomplete last varint.
+ */
+
+// buffers per register, limits the bookkeeping to a small array
+#define BATCH_MAX_PACKED 32
+
+/**
+ * Decodes the buffers in the packed register and stores the result lanes of every buffer to its output.
+ * returns: number of decompressed integers
+ */
+static size_t batch_flush(varint_batch_entry *entries, const size_t *packed_entries, size_t num_packed, vuint8m2_t packed, size_t vl)
+{
+    size_t num_varints, number_of_bytes;
+    vuint32m8_t result = vecshift_decode_u32m8(packed, vl, &num_varints, &number_of_bytes);
+
+    size_t offset = 0;
+    for (size_t i = 0; i < num_packed; i++)
+    {
+        varint_batch_entry *entry = &entries[packed_entries[i]];
+        vuint32m8_t values = offset == 0 ? result : __riscv_vslidedown_vx_u32m8(result, offset, entry->count);
+        __riscv_vse32_v_u32m8(entry->output, values, entry->count);
+        offset += entry->count;
+    }
+    return num_varints;
+}
+
+/**
+ * entries: input, length and output of every buffer, count receives the number of integers decoded from it
+ * returns: number of decompressed integers of all buffers
+ */
+size_t varint_decode_batch(varint_batch_entry *entries, size_t num_entries)
+{
+    const size_t vlmax = __riscv_vsetvlmax_e8m2();
+
+    size_t processed = 0;
+
+    vuint8m2_t packed = __riscv_vmv_v_x_u8m2(0, vlmax);
+    size_t packed_entries[BATCH_MAX_PACKED];
+    size_t num_packed = 0;
+    size_t used = 0;
+
+    for (size_t i = 0; i < num_entries; i++)
+    {
+        varint_batch_entry *entry = &entries[i];
+        const size_t length = entry->length;
+
+        if (length == 0)
+        {
+            entry->count = 0;
+            continue;
+        }
+
+        if (entry->input[length - 1] > 0x7F)
+        {
+            size_t bytes_consumed;
+            entry->count = varint_decode_vecshift_bounded(entry->input, length, entry->output, SIZE_MAX, &bytes_consumed);
+            processed += entry->count;
+            continue;
+        }
+
+        if (length > vlmax)
+        {
+            entry->count = varint_decode(entry->input, length, entry->output);
+            processed += entry->count;
+            continue;
+        }
+
+        if (used + length > vlmax || num_packed == BATCH_MAX_PACKED)
+        {
+            processed += batch_flush(entries, packed_entries, num_packed, packed, used);
+            num_packed = 0;
+            used = 0;
+        }
+
+        vuint8m2_t bytes = __riscv_vle8_v_u8m2(entry->input, length);
+        entry->count = __riscv_vcpop(__riscv_vmsleu(bytes, 0x7F, length), length);
+
+        packed = used == 0 ? bytes : __riscv_vslideup(packed, bytes, used, used + length);
+        packed_entries[num_packed++] = i;
+        used += length;
+    }
+
+    if (num_packed > 0)
+    {
+        processed += batch_flush(entries, packed_entries, num_packed, packed, used);
+    }
+    return processed;
+}
@@ -0,0 +1,92 @@
+#include "libvarintrvv.h"
+#include "varint_vecshift.h"
+
+/**
+ * Capacity bounded variants of varint_decode_vecshift and varint_decode_u64. They write at most max_values integers,
+ * so the output can be a small buffer that is reused for consecutive calls. As long as the remaining capacity is at
+ * least vl, a register can not hold too many varints and the loop is the same as in the unbounded decoders. Only the
+ * last register is shortened to the termination byte of the last varint that fits.
+ *
+ * max_values: capacity of output in integers
+ * bytes_consumed: number of bytes occupied by the decoded varints, the next call continues at input + bytes_consumed
+ * returns: number of decompressed integers, max_values unless the input ends first
+ */
+
+size_t varint_decode_vecshift_bounded(const uint8_t *data, size_t length, uint32_t *output, size_t max_values, size_t *bytes_consumed)
+{
+    const uint8_t *start = data;
+    size_t processed = 0;
+
+    size_t vl;
+
+    while (length > 0 && processed < max_values)
+    {
+        vl = __riscv_vsetvl_e8m1(length);
+
+        vuint8m1_t input = __riscv_vle8_v_u8m1(data, vl);
+
+        size_t capacity = max_values - processed;
+        if (capacity < vl)
+        {
+            vl = vecshift_limit_vl(input, vl, capacity);
+        }
+
+        size_t num_varints, number_of_bytes;
+        vuint32m4_t result = vecshift_decode_u32m4(input, vl, &num_varints, &number_of_bytes);
+
+        // the input ends inside a varint
+        if (num_varints == 0)
+        {
+            break;
+        }
+
+        __riscv_vse32_v_u32m4(output, result, num_varints);
+
+        data += number_of_bytes;
+        length -= number_of_bytes;
+        output += num_varints;
+        processed += num_varints;
+    }
+
+    *bytes_consumed = data - start;
+    return processed;
+}
+
+size_t varint_decode_u64_bounded(const uint8_t *data, size_t length, uint64_t *output, size_t max_values, size_t *bytes_consumed)
+{
+    const uint8_t *start = data;
+    size_t processed = 0;
+
+    size_t vl;
+
+    while (length > 0 && processed < max_values)
+    {
+        vl = __riscv_vsetvl_e8m1(length);
+
+        vuint8m1_t input = __riscv_vle8_v_u8m1(data, vl);
+
+        size_t capacity = max_values - processed;
+        if (capacity < vl)
+        {
+            vl = vecshift_limit_vl(input, vl, capacity);
+        }
+
+        size_t num_varints, number_of_bytes;
+        vuint64m8_t result = vecshift_decode_u64m8(input, vl, &num_varints, &number_of_bytes);
+
+        if (num_varints == 0)
+        {
+            break;
+        }
+
+        __riscv_vse64_v_u64m8(output, result, num_varints);
+
+        data += number_of_bytes;
+        length -= number_of_bytes;
+        output += num_varints;
+        processed += num_varints;
+    }
+
+    *bytes_consumed = data - start;
+    return processed;
+}
@@ -0,0 +1,117 @@
+#include "libvarintrvv.h"
+#include "varint_vecshift.h"
+
+/**
+ * Decoders for delta coded lists (e.g. sorted posting lists or offsets). The decoded deltas are turned into
+ * absolute values with an inclusive prefix sum in the vector registers: log2(vl) steps of slideup + add, then the
+ * running base carried over from the previous register is added to all lanes before the store.
+ */
+
+static inline __attribute__((always_inline)) vuint32m4_t prefix_sum_u32m4(vuint32m4_t value, uint32_t base, size_t vl)
+{
+    vuint32m4_t zero = __riscv_vmv_v_x_u32m4(0, vl);
+
+    // after step k every lane holds the sum of the (up to) 2^k lanes ending at it
+    for (size_t offset = 1; offset < vl; offset <<= 1)
+    {
+        value = __riscv_vadd(value, __riscv_vslideup(zero, value, offset, vl), vl);
+    }
+    return __riscv_vadd(value, base, vl);
+}
+
+static inline __attribute__((always_inline)) vuint64m8_t prefix_sum_u64m8(vuint64m8_t value, uint64_t base, size_t vl)
+{
+    vuint64m8_t zero = __riscv_vmv_v_x_u64m8(0, vl);
+
+    for (size_t offset = 1; offset < vl; offset <<= 1)
+    {
+        value = __riscv_vadd(value, __riscv_vslideup(zero, value, offset, vl), vl);
+    }
+    return __riscv_vadd(value, base, vl);
+}
+
+/**
+ * input: uint8_t pointer to the start of the compressed deltas
+ * output: decompressed 32-bit integers, output[i] = previous + delta[0] + ... + delta[i]
+ * length: size of the varints in bytes
+ * previous: value the first delta is relative to (0 for a new list)
+ * returns: number of decompressed integers
+ */
+size_t varint_decode_delta_u32(const uint8_t *data, size_t length, uint32_t *output, uint32_t previous)
+{
+    size_t processed = 0;
+
+    size_t vl;
+
+    while (length > 0)
+    {
+        vl = __riscv_vsetvl_e8m1(length);
+
+        vuint8m1_t input = __riscv_vle8_v_u8m1(data, vl);
+
+        size_t num_varints, number_of_bytes;
+        vuint32m4_t result = vecshift_decode_u32m4(input, vl, &num_varints, &number_of_bytes);
+
+        // the input ends inside a varint, there is no last lane to carry over
+        if (num_varints == 0)
+        {
+            break;
+        }
+
+        result = prefix_sum_u32m4(result, previous, num_varints);
+
+        __riscv_vse32_v_u32m4(output, result, num_varints);
+
+        // last lane is the base for the next register
+        previous = __riscv_vmv_x(__riscv_vslidedown(result, num_varints - 1, num_varints));
+
+        data += number_of_bytes;
+        length -= number_of_bytes;
+        output += num_varints;
+        processed += num_varints;
+    }
+    return processed;
+}
+
+/**
+ * input: uint8_t pointer to the start of the compressed deltas
+ * output: decompressed 64-bit integers, output[i] = previous + delta[0] + ... + delta[i]
+ * length: size of the varints in bytes
+ * previous: value the first delta is relative to (0 for a new list)
+ * returns: number of decompressed integers
+ */
+size_t varint_decode_delta_u64(const uint8_t *data, size_t length, uint64_t *output, uint64_t previous)
+{
+    size_t processed = 0;
+
+    size_t vl;
+
+    while (length > 0)
+    {
+        vl = __riscv_vsetvl_e8m1(length);
+
+        vuint8m1_t input = __riscv_vle8_v_u8m1(data, vl);
+
+        size_t num_varints, number_of_bytes;
+        vuint64m8_t result = vecshift_decode_u64m8(input, vl, &num_varints, &number_of_bytes);
+
+        // the input ends inside a varint, there is no last lane to carry over
+        if (num_varints == 0)
+        {
+            break;
+        }
+
+        result = prefix_sum_u64m8(result, previous, num_varints);
+
+        __riscv_vse64_v_u64m8(output, result, num_varints);
+
+        // last lane is the base for the next register
+        previous = __riscv_vmv_x(__riscv_vslidedown(result, num_varints - 1, num_varints));
+
+        data += number_of_bytes;
+        length -= number_of_bytes;
+        output += num_varints;
+        processed += num_varints;
+    }
+    return processed;
+}
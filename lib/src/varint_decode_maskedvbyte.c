@@ -1,117 +1,190 @@
 #include "libvarintrvv.h"
 #include "utils.h"
 
-static inline __attribute__((always_inline)) uint64_t create_mask(const vuint8m1_t varint_vec, const size_t vlmax_e8m1, const size_t length)
-{
-    vint8m1_t vec_i8 = __riscv_vreinterpret_v_u8m1_i8m1(varint_vec);
-
-    vbool8_t mask = __riscv_vmslt_vx_i8m1_b8(vec_i8, 0, vlmax_e8m1);
-
-    vuint8m1_t mask_as_u8 = __riscv_vreinterpret_v_b8_u8m1(mask);
-    vuint64m1_t mask_as_u64 = __riscv_vreinterpret_v_u8m1_u64m1(mask_as_u8);
-    return __riscv_vmv_x_s_u64m1_u64(mask_as_u64);
-}
-
-static inline __attribute__((always_inline)) uint64_t create_mask_m2(const vuint8m2_t varint_vec, const size_t vlmax_e8m2, const size_t length)
-{
-    vint8m2_t vec_i8 = __riscv_vreinterpret_v_u8m2_i8m2(varint_vec);
-
-    vbool4_t mask = __riscv_vmslt_vx_i8m2_b4(vec_i8, 0, vlmax_e8m2);
-
-    vuint32m1_t mask_as_u32 = __riscv_vreinterpret_v_b4_u32m1(mask);
-    vuint64m1_t mask_as_u64 = __riscv_vreinterpret_v_u32m1_u64m1(mask_as_u32);
-    return __riscv_vmv_x_s_u64m1_u64(mask_as_u64);
-}
-
-static inline __attribute__((always_inline)) uint64_t masked_vbyte_read_group(const vuint8m1_t in, uint32_t *out,
-                                                                              uint64_t mask, uint64_t *ints_read, const size_t vlmax_e8m1)
+#include <string.h>
+
+/**
+ * Masked VByte works on 16-byte groups. Every vector register holds VLEN/128 of them, so one register load decodes
+ * a chain of groups: the table lookups for all groups are done up front (each group starts where the previous one
+ * ended), their shuffle rows are concatenated and a single vrgather shuffles the bytes of all groups at once.
+ *
+ * At most 8 groups (128 bytes, VLEN=1024) are decoded per register, which keeps the per-register buffers small
+ * and the group offsets within 8 bits.
+ */
+#define MAX_GROUPS 8
+#define MAX_GROUP_BYTES (MAX_GROUPS * 16)
+
+// shuffle row of a group of 16 single byte integers
+static const int8_t single_bytes_shuffle[16] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
+
+// the rows for 6 integers keep integers 0-3 in 16-bit lanes 0, 2, 4, 6 and integers 4-5 in lanes 1, 3
+static const uint8_t six_ints_lanes[8] = {0, 2, 4, 6, 1, 3, 5, 7};
+
+/**
+ * Looks up the group starting at bit `start` of the continuation bit mask and appends its shuffle row.
+ * ints_read: number of integers in the group (16, 6, 4 or 2), identifies how the shuffled bytes are combined
+ * returns: number of bytes consumed by the group
+ */
+static inline __attribute__((always_inline)) uint64_t masked_vbyte_lookup_group(const uint8_t *mask_bytes, size_t start,
+                                                                                int8_t *shuffle, uint8_t *ints_read)
 {
+    uint32_t mask;
+    memcpy(&mask, &mask_bytes[start / 8], sizeof(mask));
+    mask >>= start % 8;
 
     // fast path, all 16 bytes contain separate integers < 128
     if (!(mask & 0xFFFF))
     {
-        vuint32m4_t extended_result = __riscv_vzext_vf4_u32m4(in, vlmax_e8m1);
-        __riscv_vse32_v_u32m4(out, extended_result, 16);
+        memcpy(shuffle, single_bytes_shuffle, 16);
         *ints_read = 16;
         return 16;
     }
 
-    const size_t vlmax_e16m1 = vlmax_e8m1 / 2;
-    const size_t vlmax_e32m1 = vlmax_e8m1 / 4;
-    const size_t vlmax_e64m1 = vlmax_e8m1 / 8;
-
     uint32_t low_12_bits = mask & 0xFFF;
     index_bytes_consumed combined = combined_lookup[low_12_bits];
-    uint64_t consumed = combined.bytes_consumed;
-    uint8_t index = combined.index;
-
-    vint8m1_t vectors = __riscv_vle8_v_i8m1(&vectorsrawbytes[index * 16], 128 / 8);
+    const int8_t *row = &vectorsrawbytes[combined.index * 16];
 
-    if (index < 64)
+    if (combined.index < 64)
     {
+        // reorder the 16-bit lanes, so that the integers are in lanes 0-5
+        for (size_t lane = 0; lane < 8; lane++)
+        {
+            memcpy(&shuffle[lane * 2], &row[six_ints_lanes[lane] * 2], 2);
+        }
         *ints_read = 6;
-        vuint8m1_t shuffled = __riscv_vrgather_vv_u8m1(in, __riscv_vreinterpret_v_i8m1_u8m1(vectors), vlmax_e8m1);
-        vuint16m1_t low_bytes = __riscv_vand_vx_u16m1(__riscv_vreinterpret_v_u8m1_u16m1(shuffled), 0x007F, vlmax_e16m1);
-        vuint16m1_t high_bytes = __riscv_vand_vx_u16m1(__riscv_vreinterpret_v_u8m1_u16m1(shuffled), 0x7F00, vlmax_e16m1);
-        vuint16m1_t high_bytes_shifted = __riscv_vsrl_vx_u16m1(high_bytes, 1, vlmax_e16m1);
-        vuint16m1_t packed_result = __riscv_vor_vv_u16m1(high_bytes_shifted, low_bytes, vlmax_e16m1);
-        vuint32m1_t unpacked_result_a = __riscv_vand_vx_u32m1(__riscv_vreinterpret_v_u16m1_u32m1(packed_result), 0x0000FFFF, vlmax_e32m1);
-        __riscv_vse32_v_u32m1(out, unpacked_result_a, 4);
-        vuint32m1_t unpacked_result_b = __riscv_vsrl_vx_u32m1(__riscv_vreinterpret_v_u16m1_u32m1(packed_result), 16, vlmax_e32m1);
-        __riscv_vse32_v_u32m1(out + 4, unpacked_result_b, 2);
-        return consumed;
+    }
+    else
+    {
+        memcpy(shuffle, row, 16);
+        *ints_read = combined.index < 145 ? 4 : 2;
+    }
+    return combined.bytes_consumed;
+}
+
+/**
+ * Combines the shuffled bytes of `groups` consecutive groups of the same kind and stores the integers.
+ * returns: number of integers written
+ */
+static inline __attribute__((always_inline)) size_t masked_vbyte_store_groups(const vuint8m1_t shuffled, uint32_t *out,
+                                                                             uint8_t ints_per_group, size_t groups)
+{
+    const size_t vl_e8m1 = groups * 16;
+    const size_t vl_e16m1 = vl_e8m1 / 2;
+    const size_t vl_e32m1 = vl_e8m1 / 4;
+    const size_t vl_e64m1 = vl_e8m1 / 8;
+
+    if (ints_per_group == 16)
+    {
+        vuint32m4_t extended_result = __riscv_vzext_vf4_u32m4(shuffled, vl_e8m1);
+        __riscv_vse32_v_u32m4(out, extended_result, vl_e8m1);
+        return vl_e8m1;
+    }
+
+    if (ints_per_group == 6)
+    {
+        vuint16m1_t low_bytes = __riscv_vand_vx_u16m1(__riscv_vreinterpret_v_u8m1_u16m1(shuffled), 0x007F, vl_e16m1);
+        vuint16m1_t high_bytes = __riscv_vand_vx_u16m1(__riscv_vreinterpret_v_u8m1_u16m1(shuffled), 0x7F00, vl_e16m1);
+        vuint16m1_t high_bytes_shifted = __riscv_vsrl_vx_u16m1(high_bytes, 1, vl_e16m1);
+        vuint16m1_t packed_result = __riscv_vor_vv_u16m1(high_bytes_shifted, low_bytes, vl_e16m1);
+
+        // drop the two unused lanes of every group
+        vuint16m1_t lane_in_group = __riscv_vand_vx_u16m1(__riscv_vid_v_u16m1(vl_e16m1), 7, vl_e16m1);
+        vbool16_t used_lanes = __riscv_vmsltu_vx_u16m1_b16(lane_in_group, 6, vl_e16m1);
+        vuint16m1_t result = __riscv_vcompress_vm_u16m1(packed_result, used_lanes, vl_e16m1);
+
+        __riscv_vse32_v_u32m2(out, __riscv_vzext_vf2_u32m2(result, groups * 6), groups * 6);
+        return groups * 6;
     }
 
-    if (index < 145)
+    if (ints_per_group == 4)
     {
-        *ints_read = 4;
-        vuint8m1_t shuffled = __riscv_vrgather_vv_u8m1(in, __riscv_vreinterpret_v_i8m1_u8m1(vectors), vlmax_e8m1);
         vuint32m1_t shuffled32 = __riscv_vreinterpret_v_u8m1_u32m1(shuffled);
-        vuint32m1_t low_bytes = __riscv_vand_vx_u32m1(shuffled32, 0x0000007F, vlmax_e32m1);
-        vuint32m1_t middle_bytes = __riscv_vand_vx_u32m1(shuffled32, 0x00007F00, vlmax_e32m1);
-        vuint32m1_t high_bytes = __riscv_vand_vx_u32m1(shuffled32, 0x007F0000, vlmax_e32m1);
-        vuint32m1_t middle_bytes_shifted = __riscv_vsrl_vx_u32m1(middle_bytes, 1, vlmax_e32m1);
-        vuint32m1_t high_bytes_shifted = __riscv_vsrl_vx_u32m1(high_bytes, 2, vlmax_e32m1);
-        vuint32m1_t low_middle = __riscv_vor_vv_u32m1(low_bytes, middle_bytes_shifted, vlmax_e32m1);
-        vuint32m1_t result = __riscv_vor_vv_u32m1(low_middle, high_bytes_shifted, vlmax_e32m1);
-        __riscv_vse32_v_u32m1(out, result, 4);
-        return consumed;
+        vuint32m1_t low_bytes = __riscv_vand_vx_u32m1(shuffled32, 0x0000007F, vl_e32m1);
+        vuint32m1_t middle_bytes = __riscv_vand_vx_u32m1(shuffled32, 0x00007F00, vl_e32m1);
+        vuint32m1_t high_bytes = __riscv_vand_vx_u32m1(shuffled32, 0x007F0000, vl_e32m1);
+        vuint32m1_t middle_bytes_shifted = __riscv_vsrl_vx_u32m1(middle_bytes, 1, vl_e32m1);
+        vuint32m1_t high_bytes_shifted = __riscv_vsrl_vx_u32m1(high_bytes, 2, vl_e32m1);
+        vuint32m1_t low_middle = __riscv_vor_vv_u32m1(low_bytes, middle_bytes_shifted, vl_e32m1);
+        vuint32m1_t result = __riscv_vor_vv_u32m1(low_middle, high_bytes_shifted, vl_e32m1);
+
+        __riscv_vse32_v_u32m1(out, result, vl_e32m1);
+        return vl_e32m1;
     }
 
-    *ints_read = 2;
-
-    vuint8m1_t data_bits = __riscv_vand_vx_u8m1(in, 0x7F, vlmax_e8m1);
-    vuint8m1_t shuffled = __riscv_vrgather_vv_u8m1(data_bits, __riscv_vreinterpret_v_i8m1_u8m1(vectors), vlmax_e8m1);
-    vuint64m1_t constant_vec = __riscv_vmv_v_x_u64m1(0x0010002000400080, vlmax_e64m1);
-    vuint16m1_t split_bytes = __riscv_vmul_vv_u16m1(__riscv_vreinterpret_v_u8m1_u16m1(shuffled), __riscv_vreinterpret_v_u64m1_u16m1(constant_vec), vlmax_e16m1);
-    vuint64m1_t shifted_split_bytes = __riscv_vsll_vx_u64m1(__riscv_vreinterpret_v_u16m1_u64m1(split_bytes), 8, vlmax_e64m1);
-    vuint64m1_t recombined = __riscv_vor_vv_u64m1(shifted_split_bytes, __riscv_vreinterpret_v_u16m1_u64m1(split_bytes), vlmax_e64m1);
-    vuint64m1_t low_byte = __riscv_vsrl_vx_u64m1(__riscv_vreinterpret_v_u8m1_u64m1(shuffled), 56, vlmax_e64m1);
-    vuint64m1_t result_evens = __riscv_vor_vv_u64m1(recombined, low_byte, vlmax_e64m1);
-    uint8_t gather_index[] = {0, 2, 4, 6, 8, 10, 12, 14, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
-    vuint8m1_t gather_vec = __riscv_vle8_v_u8m1(gather_index, vlmax_e8m1);
-    vuint8m1_t result = __riscv_vrgather_vv_u8m1(__riscv_vreinterpret_v_u64m1_u8m1(result_evens), gather_vec, vlmax_e8m1);
-    __riscv_vse32_v_u32m1(out, __riscv_vreinterpret_v_u8m1_u32m1(result), 2);
-
-    return consumed;
+    vuint8m1_t data_bits = __riscv_vand_vx_u8m1(shuffled, 0x7F, vl_e8m1);
+    vuint64m1_t constant_vec = __riscv_vmv_v_x_u64m1(0x0010002000400080, vl_e64m1);
+    vuint16m1_t split_bytes = __riscv_vmul_vv_u16m1(__riscv_vreinterpret_v_u8m1_u16m1(data_bits), __riscv_vreinterpret_v_u64m1_u16m1(constant_vec), vl_e16m1);
+    vuint64m1_t shifted_split_bytes = __riscv_vsll_vx_u64m1(__riscv_vreinterpret_v_u16m1_u64m1(split_bytes), 8, vl_e64m1);
+    vuint64m1_t recombined = __riscv_vor_vv_u64m1(shifted_split_bytes, __riscv_vreinterpret_v_u16m1_u64m1(split_bytes), vl_e64m1);
+    vuint64m1_t low_byte = __riscv_vsrl_vx_u64m1(__riscv_vreinterpret_v_u8m1_u64m1(data_bits), 56, vl_e64m1);
+    vuint64m1_t result_evens = __riscv_vor_vv_u64m1(recombined, low_byte, vl_e64m1);
+
+    // the integers are the even bytes of the 64-bit lanes, i.e. the low bytes of the 16-bit lanes
+    vuint8mf2_t result = __riscv_vncvt_x_x_w_u8mf2(__riscv_vreinterpret_v_u64m1_u16m1(result_evens), vl_e16m1);
+    __riscv_vse8_v_u8mf2((uint8_t *)out, result, vl_e16m1);
+    return vl_e64m1;
 }
 
 size_t varint_decode_masked_vbyte(const uint8_t *input, size_t length, uint32_t *output)
 {
-    const size_t vlmax_e8m1 = 16;
-    uint64_t ints_read = 0;
     uint64_t ints_processed = 0;
 
+    // continuation bits of the register, padded so that 32 bits can be read at every group start
+    uint8_t mask_bytes[MAX_GROUP_BYTES / 8 + 4] = {0};
+    int8_t shuffle_bytes[MAX_GROUP_BYTES];
+    uint8_t offset_bytes[MAX_GROUP_BYTES];
+    uint8_t ints_read[MAX_GROUPS];
+
     while (length >= 16)
     {
-        const vuint8m1_t varint_vec = __riscv_vle8_v_u8m1(input, vlmax_e8m1);
-        const uint64_t mask = create_mask(varint_vec, vlmax_e8m1, length);
-        uint64_t consumed = masked_vbyte_read_group(varint_vec, output, mask, &ints_read, vlmax_e8m1);
+        size_t vl = __riscv_vsetvl_e8m1(length < MAX_GROUP_BYTES ? length : MAX_GROUP_BYTES);
+
+        const vuint8m1_t varint_vec = __riscv_vle8_v_u8m1(input, vl);
+
+        vbool8_t mask = __riscv_vmslt_vx_i8m1_b8(__riscv_vreinterpret_v_u8m1_i8m1(varint_vec), 0, vl);
+        __riscv_vsm_v_b8(mask_bytes, mask, vl);
+
+        // batched lookups, as many groups as the register can hold after the shuffle
+        size_t groups = 0;
+        uint64_t consumed = 0;
+        while (groups < vl / 16 && consumed + 16 <= vl)
+        {
+            memset(&offset_bytes[groups * 16], (int)consumed, 16);
+            consumed += masked_vbyte_lookup_group(mask_bytes, consumed, &shuffle_bytes[groups * 16], &ints_read[groups]);
+            groups++;
+        }
+
+        // move the group relative indices to the position of the group in the register and shuffle all groups at once
+        const size_t vl_groups = groups * 16;
+        vuint8m1_t shuffle = __riscv_vreinterpret_v_i8m1_u8m1(__riscv_vle8_v_i8m1(shuffle_bytes, vl_groups));
+        vuint8m1_t offsets = __riscv_vle8_v_u8m1(offset_bytes, vl_groups);
+        vbool8_t used_bytes = __riscv_vmsne_vx_u8m1_b8(shuffle, 0xFF, vl_groups);
+        shuffle = __riscv_vadd_vv_u8m1_mu(used_bytes, shuffle, shuffle, offsets, vl_groups);
+
+        // unused bytes (-1 in the rows) are zero, independent of VLMAX
+        vuint8m1_t zero = __riscv_vmv_v_x_u8m1(0, vl_groups);
+        vuint8m1_t shuffled = __riscv_vrgather_vv_u8m1_mu(used_bytes, zero, varint_vec, shuffle, vl_groups);
+
+        // combine runs of groups of the same kind together
+        size_t group = 0;
+        while (group < groups)
+        {
+            size_t run = 1;
+            while (group + run < groups && ints_read[group + run] == ints_read[group])
+            {
+                run++;
+            }
+
+            vuint8m1_t run_bytes = group == 0 ? shuffled : __riscv_vslidedown_vx_u8m1(shuffled, group * 16, run * 16);
+            size_t ints = masked_vbyte_store_groups(run_bytes, output, ints_read[group], run);
+
+            output += ints;
+            ints_processed += ints;
+            group += run;
+        }
 
         length -= consumed;
         input += consumed;
-        output += ints_read;
-        ints_processed += ints_read;
     }
     if (length > 0)
     {
@@ -120,4 +193,3 @@ size_t varint_decode_masked_vbyte(const uint8_t *input, size_t length, uint32_t
 
     return ints_processed;
 }
-
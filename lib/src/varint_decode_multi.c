@@ -0,0 +1,136 @@
+#include "libvarintrvv.h"
+#include "varint_vecshift.h"
+
+/**
+ * Decodes several independent streams in lockstep. Within one stream every iteration of the vecshift loop depends on
+ * number_of_bytes of the previous one and the kernel itself is a long chain of slides, compresses and widening
+ * multiply-adds. Streams of different columns are independent, so the loop advances 2 or 4 of them per iteration:
+ * all loads first, then the kernels, then the stores. The scheduler can overlap the chains of the streams and the
+ * stores of one stream can not alias the loads of the others within the iteration.
+ *
+ * Once the shortest stream of a group ends, the others are finished on their own. A truncated last varint ends its
+ * stream and is not decoded.
+ */
+
+typedef struct multi_stream
+{
+    const uint8_t *input;
+    size_t length;
+    uint32_t *output;
+} multi_stream;
+
+static inline __attribute__((always_inline)) multi_stream multi_stream_start(const varint_batch_entry *entry)
+{
+    multi_stream stream = {entry->input, entry->length, entry->output};
+    return stream;
+}
+
+static inline __attribute__((always_inline)) void multi_stream_advance(multi_stream *stream, size_t num_varints, size_t number_of_bytes)
+{
+    stream->input += number_of_bytes;
+    stream->output += num_varints;
+    // no complete varint in the register: the stream ends in a truncated varint
+    stream->length = number_of_bytes == 0 ? 0 : stream->length - number_of_bytes;
+}
+
+// decodes the rest of the stream alone and sets the count of the entry
+static size_t multi_stream_finish(varint_batch_entry *entry, multi_stream *stream)
+{
+    size_t bytes_consumed;
+    stream->output += varint_decode_vecshift_bounded(stream->input, stream->length, stream->output, SIZE_MAX, &bytes_consumed);
+    entry->count = stream->output - entry->output;
+    return entry->count;
+}
+
+static size_t multi_decode_x2(varint_batch_entry *entries)
+{
+    multi_stream a = multi_stream_start(&entries[0]);
+    multi_stream b = multi_stream_start(&entries[1]);
+
+    while (a.length > 0 && b.length > 0)
+    {
+        size_t vl_a = __riscv_vsetvl_e8m1(a.length);
+        size_t vl_b = __riscv_vsetvl_e8m1(b.length);
+
+        vuint8m1_t input_a = __riscv_vle8_v_u8m1(a.input, vl_a);
+        vuint8m1_t input_b = __riscv_vle8_v_u8m1(b.input, vl_b);
+
+        size_t num_a, bytes_a, num_b, bytes_b;
+        vuint32m4_t result_a = vecshift_decode_u32m4(input_a, vl_a, &num_a, &bytes_a);
+        vuint32m4_t result_b = vecshift_decode_u32m4(input_b, vl_b, &num_b, &bytes_b);
+
+        __riscv_vse32_v_u32m4(a.output, result_a, num_a);
+        __riscv_vse32_v_u32m4(b.output, result_b, num_b);
+
+        multi_stream_advance(&a, num_a, bytes_a);
+        multi_stream_advance(&b, num_b, bytes_b);
+    }
+
+    return multi_stream_finish(&entries[0], &a) + multi_stream_finish(&entries[1], &b);
+}
+
+static size_t multi_decode_x4(varint_batch_entry *entries)
+{
+    multi_stream a = multi_stream_start(&entries[0]);
+    multi_stream b = multi_stream_start(&entries[1]);
+    multi_stream c = multi_stream_start(&entries[2]);
+    multi_stream d = multi_stream_start(&entries[3]);
+
+    while (a.length > 0 && b.length > 0 && c.length > 0 && d.length > 0)
+    {
+        size_t vl_a = __riscv_vsetvl_e8m1(a.length);
+        size_t vl_b = __riscv_vsetvl_e8m1(b.length);
+        size_t vl_c = __riscv_vsetvl_e8m1(c.length);
+        size_t vl_d = __riscv_vsetvl_e8m1(d.length);
+
+        vuint8m1_t input_a = __riscv_vle8_v_u8m1(a.input, vl_a);
+        vuint8m1_t input_b = __riscv_vle8_v_u8m1(b.input, vl_b);
+        vuint8m1_t input_c = __riscv_vle8_v_u8m1(c.input, vl_c);
+        vuint8m1_t input_d = __riscv_vle8_v_u8m1(d.input, vl_d);
+
+        size_t num_a, bytes_a, num_b, bytes_b, num_c, bytes_c, num_d, bytes_d;
+        vuint32m4_t result_a = vecshift_decode_u32m4(input_a, vl_a, &num_a, &bytes_a);
+        vuint32m4_t result_b = vecshift_decode_u32m4(input_b, vl_b, &num_b, &bytes_b);
+        vuint32m4_t result_c = vecshift_decode_u32m4(input_c, vl_c, &num_c, &bytes_c);
+        vuint32m4_t result_d = vecshift_decode_u32m4(input_d, vl_d, &num_d, &bytes_d);
+
+        __riscv_vse32_v_u32m4(a.output, result_a, num_a);
+        __riscv_vse32_v_u32m4(b.output, result_b, num_b);
+        __riscv_vse32_v_u32m4(c.output, result_c, num_c);
+        __riscv_vse32_v_u32m4(d.output, result_d, num_d);
+
+        multi_stream_advance(&a, num_a, bytes_a);
+        multi_stream_advance(&b, num_b, bytes_b);
+        multi_stream_advance(&c, num_c, bytes_c);
+        multi_stream_advance(&d, num_d, bytes_d);
+    }
+
+    return multi_stream_finish(&entries[0], &a) + multi_stream_finish(&entries[1], &b) +
+           multi_stream_finish(&entries[2], &c) + multi_stream_finish(&entries[3], &d);
+}
+
+/**
+ * streams: input, length and output of every stream, count receives the number of integers decoded from it
+ * returns: number of decompressed integers of all streams
+ */
+size_t varint_decode_multi(varint_batch_entry *streams, size_t num_streams)
+{
+    size_t processed = 0;
+    size_t i = 0;
+
+    for (; i + 4 <= num_streams; i += 4)
+    {
+        processed += multi_decode_x4(&streams[i]);
+    }
+    if (i + 2 <= num_streams)
+    {
+        processed += multi_decode_x2(&streams[i]);
+        i += 2;
+    }
+    if (i < num_streams)
+    {
+        multi_stream single = multi_stream_start(&streams[i]);
+        processed += multi_stream_finish(&streams[i], &single);
+    }
+    return processed;
+}
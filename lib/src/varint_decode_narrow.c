@@ -0,0 +1,201 @@
+#include "libvarintrvv.h"
+
+/**
+ * Decoders with narrow uint16_t / uint8_t output for fields known to fit in 16 or 8 bits. Results are built and
+ * stored at e16 / e8, so the store bandwidth is cut by 2x / 4x compared to varint_decode_vecshift.
+ *
+ * Overflow policy: values that do not fit into the output type saturate to UINT16_MAX / UINT8_MAX. Overlong
+ * varints (up to the 10 bytes of 64-bit varints) are consumed as a whole, so decoding stays in sync with the input.
+ */
+
+/**
+ * Number of bytes occupied by complete varints, i.e. index of the last termination byte + 1.
+ * Only needed when varints longer than the output type can hold are present in the register.
+ */
+static inline __attribute__((always_inline)) size_t complete_varint_bytes(vbool8_t termination_mask, size_t vl)
+{
+    // e16 indices, so that index + 1 cannot wrap for any VLEN
+    vuint16m2_t index = __riscv_vadd(__riscv_vid_v_u16m2(vl), 1, vl);
+
+    vuint16m1_t last = __riscv_vredmaxu(termination_mask, index, __riscv_vmv_s_x_u16m1(0, 1), vl);
+
+    return __riscv_vmv_x(last);
+}
+
+/**
+ * input: uint8_t pointer to the start of the compressed varints
+ * output: decompressed 16-bit integers, saturated to UINT16_MAX
+ * length: size of the varints in bytes
+ * returns: number of decompressed integers
+ */
+size_t varint_decode_u16(const uint8_t *data, size_t length, uint16_t *output)
+{
+    size_t processed = 0;
+
+    size_t vl;
+
+    while (length > 0)
+    {
+        vl = __riscv_vsetvl_e8m1(length);
+
+        vuint8m1_t input = __riscv_vle8_v_u8m1(data, vl);
+
+        // mask set when element has termination bit (MSB==0) set
+        vbool8_t termination_mask = __riscv_vmsleu(input, 0x7F, vl);
+
+        size_t num_varints = __riscv_vcpop(termination_mask, vl);
+
+        // fast path. No continuation bits (MSB==1) set
+        if (num_varints == vl)
+        {
+            // expand every byte to 16-bit lane and save to memory
+            __riscv_vse16_v_u16m2(output, __riscv_vzext_vf2(input, vl), vl);
+
+            data += vl;
+            length -= vl;
+            output += vl;
+            processed += vl;
+        }
+        else
+        {
+            vuint8m1_t v1 = __riscv_vslide1down(input, 0, vl);
+
+            // every byte after a termination byte is as first byte
+            vuint8m1_t v_prev = __riscv_vslide1up(input, 0, vl);
+            vbool8_t m_first_bytes = __riscv_vmsleu(v_prev, 0x7F, vl);
+
+            vuint8m1_t first_bytes = __riscv_vcompress(input, m_first_bytes, vl);
+            vuint8m1_t second_bytes = __riscv_vcompress(v1, m_first_bytes, vl);
+
+            vbool8_t m_second_bytes = __riscv_vmsgtu(first_bytes, 0x7F, vl);
+            vbool8_t m_third_bytes = __riscv_vmand(m_second_bytes, __riscv_vmsgtu(second_bytes, 0x7F, vl), vl);
+
+            // remove continuation bits (bit 7) from payload bytes
+            vuint8m1_t b1 = __riscv_vand(first_bytes, 0x7F, vl);
+            vuint8m1_t b2 = __riscv_vand(second_bytes, 0x7F, vl);
+
+            // b1: bits 0-6 b2: bits 7-13 (shift by 7, i.e., multiply by 128)
+            vuint16m2_t result12 = __riscv_vwmaccu_mu(m_second_bytes, __riscv_vzext_vf2(b1, vl), 128, b2, vl);
+
+            // Use num_varints as vl to exclude any incomplete varint at the end
+            size_t count2 = __riscv_vcpop(m_second_bytes, num_varints);
+            size_t count3 = __riscv_vcpop(m_third_bytes, num_varints);
+
+            size_t number_of_bytes = num_varints + count2 + count3;
+
+            if (count3 == 0)
+            {
+                __riscv_vse16_v_u16m2(output, result12, num_varints);
+            }
+            else
+            {
+                vuint8m1_t v2 = __riscv_vslide1down(v1, 0, vl);
+
+                vuint8m1_t third_bytes = __riscv_vcompress(v2, m_first_bytes, vl);
+
+                vbool8_t m_fourth_bytes = __riscv_vmand(m_third_bytes, __riscv_vmsgtu(third_bytes, 0x7F, vl), vl);
+
+                vuint8m1_t b3 = __riscv_vand(third_bytes, 0x7F, vl);
+
+                // b3: bits 14-20, built in 32-bit lanes so that values above 16 bits can be detected
+                vuint32m4_t result123 = __riscv_vwmaccu_mu(m_third_bytes, __riscv_vzext_vf2(result12, vl), 16384, __riscv_vzext_vf2(b3, vl), vl);
+
+                if (__riscv_vcpop(m_fourth_bytes, num_varints) > 0)
+                {
+                    // varints with 4 or more bytes never fit
+                    result123 = __riscv_vmerge(result123, UINT16_MAX, m_fourth_bytes, vl);
+                    number_of_bytes = complete_varint_bytes(termination_mask, vl);
+                }
+
+                // saturate and narrow to 16-bit lanes
+                vuint16m2_t result = __riscv_vncvt_x(__riscv_vminu(result123, UINT16_MAX, vl), vl);
+
+                __riscv_vse16_v_u16m2(output, result, num_varints);
+            }
+
+            data += number_of_bytes;
+            length -= number_of_bytes;
+            output += num_varints;
+            processed += num_varints;
+        }
+    }
+    return processed;
+}
+
+/**
+ * input: uint8_t pointer to the start of the compressed varints
+ * output: decompressed 8-bit integers, saturated to UINT8_MAX
+ * length: size of the varints in bytes
+ * returns: number of decompressed integers
+ */
+size_t varint_decode_u8(const uint8_t *data, size_t length, uint8_t *output)
+{
+    size_t processed = 0;
+
+    size_t vl;
+
+    while (length > 0)
+    {
+        vl = __riscv_vsetvl_e8m1(length);
+
+        vuint8m1_t input = __riscv_vle8_v_u8m1(data, vl);
+
+        // mask set when element has termination bit (MSB==0) set
+        vbool8_t termination_mask = __riscv_vmsleu(input, 0x7F, vl);
+
+        size_t num_varints = __riscv_vcpop(termination_mask, vl);
+
+        // fast path. No continuation bits (MSB==1) set, the input bytes are the decoded values
+        if (num_varints == vl)
+        {
+            __riscv_vse8_v_u8m1(output, input, vl);
+
+            data += vl;
+            length -= vl;
+            output += vl;
+            processed += vl;
+        }
+        else
+        {
+            vuint8m1_t v1 = __riscv_vslide1down(input, 0, vl);
+
+            // every byte after a termination byte is as first byte
+            vuint8m1_t v_prev = __riscv_vslide1up(input, 0, vl);
+            vbool8_t m_first_bytes = __riscv_vmsleu(v_prev, 0x7F, vl);
+
+            vuint8m1_t first_bytes = __riscv_vcompress(input, m_first_bytes, vl);
+            vuint8m1_t second_bytes = __riscv_vcompress(v1, m_first_bytes, vl);
+
+            vbool8_t m_second_bytes = __riscv_vmsgtu(first_bytes, 0x7F, vl);
+            vbool8_t m_third_bytes = __riscv_vmand(m_second_bytes, __riscv_vmsgtu(second_bytes, 0x7F, vl), vl);
+
+            // remove continuation bits (bit 7) from payload bytes
+            vuint8m1_t b1 = __riscv_vand(first_bytes, 0x7F, vl);
+            vuint8m1_t b2 = __riscv_vand(second_bytes, 0x7F, vl);
+
+            // b1: bits 0-6 b2: bits 7-13 (shift by 7, i.e., multiply by 128)
+            vuint16m2_t result12 = __riscv_vwmaccu_mu(m_second_bytes, __riscv_vzext_vf2(b1, vl), 128, b2, vl);
+
+            size_t count2 = __riscv_vcpop(m_second_bytes, num_varints);
+            size_t number_of_bytes = num_varints + count2;
+
+            if (__riscv_vcpop(m_third_bytes, num_varints) > 0)
+            {
+                // varints with 3 or more bytes never fit
+                result12 = __riscv_vmerge(result12, UINT8_MAX, m_third_bytes, vl);
+                number_of_bytes = complete_varint_bytes(termination_mask, vl);
+            }
+
+            // saturate and narrow to 8-bit lanes
+            vuint8m1_t result = __riscv_vncvt_x(__riscv_vminu(result12, UINT8_MAX, vl), vl);
+
+            __riscv_vse8_v_u8m1(output, result, num_varints);
+
+            data += number_of_bytes;
+            length -= number_of_bytes;
+            output += num_varints;
+            processed += num_varints;
+        }
+    }
+    return processed;
+}
@@ -0,0 +1,56 @@
+#include "libvarintrvv.h"
+#include "varint_vecshift.h"
+
+/**
+ * varint_decode_vecshift with non-temporal output stores, for outputs that are much larger than the last-level
+ * cache and are consumed much later. Every vse32 is preceded by the Zihintntl hint ntl.all, which tells the core
+ * that the stored lines will not be reused soon, so they do not evict the caller's working set. The hint has to
+ * be the instruction right in front of the store, therefore both are emitted in one asm statement together with
+ * the vsetvli for the store. ntl.all is encoded as add x0, x0, x5, a HINT that is a nop on cores without
+ * Zihintntl.
+ */
+
+static inline __attribute__((always_inline)) void vecshift_store_nt_u32m4(uint32_t *output, vuint32m4_t values, size_t vl)
+{
+#if defined(__riscv)
+    __asm__ volatile("vsetvli zero, %2, e32, m4, ta, ma\n\t"
+                     "add zero, zero, t0\n\t" // ntl.all
+                     "vse32.v %1, (%0)"
+                     :
+                     : "r"(output), "vr"(values), "r"(vl)
+                     : "memory", "vl", "vtype");
+#else
+    __riscv_vse32_v_u32m4(output, values, vl);
+#endif
+}
+
+/**
+ * input: uint8_t pointer to the start of the compressed varints
+ * output: decompressed 32-bit integers, written with non-temporal stores
+ * length: size of the varints in bytes
+ * returns: number of decompressed integers
+ */
+size_t varint_decode_nt(const uint8_t *data, size_t length, uint32_t *output)
+{
+    size_t processed = 0;
+
+    size_t vl;
+
+    while (length > 0)
+    {
+        vl = __riscv_vsetvl_e8m1(length);
+
+        vuint8m1_t input = __riscv_vle8_v_u8m1(data, vl);
+
+        size_t num_varints, number_of_bytes;
+        vuint32m4_t result = vecshift_decode_u32m4(input, vl, &num_varints, &number_of_bytes);
+
+        vecshift_store_nt_u32m4(output, result, num_varints);
+
+        data += number_of_bytes;
+        length -= number_of_bytes;
+        output += num_varints;
+        processed += num_varints;
+    }
+    return processed;
+}
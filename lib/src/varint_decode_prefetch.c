@@ -0,0 +1,68 @@
+#include "libvarintrvv.h"
+
+/**
+ * Decoder for buffers that exceed the L2 cache. The input is decoded in steps of PREFETCH_STEP_SIZE bytes, cut
+ * after a termination byte, so a step and its output (at most 4x the step) stay in the L1 data cache while it is
+ * decoded. Before every step, the input up to `distance` bytes behind the end of the step is requested with
+ * __builtin_prefetch, which is prefetch.r of Zicbop (see CMakeLists.txt). The prefetches are spread over the
+ * steps: each step only requests the lines that the decode position advanced by, the requests run `distance`
+ * bytes ahead and have that long to complete. Prefetch instructions are hints, cores without Zicbop execute them
+ * as nops.
+ */
+
+#define PREFETCH_STEP_SIZE 1024
+#define PREFETCH_LINE_SIZE 64
+// two 4 KB pages ahead of the decode position
+#define PREFETCH_DEFAULT_DISTANCE 8192
+
+/**
+ * input: uint8_t pointer to the start of the compressed varints
+ * output: decompressed 32-bit integers
+ * length: size of the varints in bytes
+ * distance: how far ahead of the decoded step the input is prefetched in bytes, 0 for the default
+ * returns: number of decompressed integers
+ */
+size_t varint_decode_prefetch(const uint8_t *data, size_t length, uint32_t *output, size_t distance)
+{
+    const uint8_t *end = data + length;
+    const uint8_t *prefetched = data;
+
+    size_t processed = 0;
+
+    if (distance == 0)
+    {
+        distance = PREFETCH_DEFAULT_DISTANCE;
+    }
+
+    while (length > 0)
+    {
+        size_t step = length;
+
+        if (length > PREFETCH_STEP_SIZE)
+        {
+            step = PREFETCH_STEP_SIZE;
+            while (step > 0 && data[step - 1] > 0x7F)
+            {
+                step--;
+            }
+            if (step == 0)
+            {
+                step = length;
+            }
+        }
+
+        const uint8_t *target = (size_t)(end - data) > step + distance ? data + step + distance : end;
+        for (; prefetched < target; prefetched += PREFETCH_LINE_SIZE)
+        {
+            __builtin_prefetch(prefetched, 0, 3);
+        }
+
+        size_t num_varints = varint_decode(data, step, output);
+
+        data += step;
+        length -= step;
+        output += num_varints;
+        processed += num_varints;
+    }
+    return processed;
+}
@@ -0,0 +1,123 @@
+#include "libvarintrvv.h"
+#include "varint_vecshift.h"
+
+/**
+ * Checked variants of varint_decode_vecshift and varint_decode_u64 for untrusted input. Every register is checked
+ * with a few mask operations (vecshift_error_mask_*) before it is decoded, so no separate validation pass is needed.
+ * On an invalid register only the varints in front of the first invalid one are decoded.
+ *
+ * values_written: number of decoded integers, all varints in front of the first invalid one
+ * bytes_consumed: number of bytes occupied by these varints, i.e. the offset of the invalid varint
+ * returns: VARINT_OK or the error of the first invalid varint
+ */
+
+varint_status varint_decode_vecshift_safe(const uint8_t *data, size_t length, uint32_t *output, size_t *values_written, size_t *bytes_consumed)
+{
+    const uint8_t *start = data;
+    size_t processed = 0;
+    varint_status status = VARINT_OK;
+
+    size_t vl;
+
+    while (length > 0)
+    {
+        vl = __riscv_vsetvl_e8m1(length);
+
+        vuint8m1_t input = __riscv_vle8_v_u8m1(data, vl);
+
+        long error = __riscv_vfirst(vecshift_error_mask_u32(input, vl), vl);
+        if (error >= 0)
+        {
+            // the first marked byte is the fifth byte of the invalid varint
+            status = data[error] > 0x7F ? VARINT_OVERLONG : VARINT_OVERFLOW;
+
+            // decode the complete varints in front of it
+            vl = error - 4;
+            if (vl == 0)
+            {
+                break;
+            }
+        }
+
+        size_t num_varints, number_of_bytes;
+        vuint32m4_t result = vecshift_decode_u32m4(input, vl, &num_varints, &number_of_bytes);
+
+        __riscv_vse32_v_u32m4(output, result, num_varints);
+
+        data += number_of_bytes;
+        length -= number_of_bytes;
+        output += num_varints;
+        processed += num_varints;
+
+        if (status != VARINT_OK)
+        {
+            break;
+        }
+
+        // the last register ends inside a varint that is shorter than 5 bytes
+        if (num_varints == 0 || (vl == length + number_of_bytes && length > 0))
+        {
+            status = VARINT_TRUNCATED;
+            break;
+        }
+    }
+
+    *values_written = processed;
+    *bytes_consumed = data - start;
+    return status;
+}
+
+varint_status varint_decode_u64_safe(const uint8_t *data, size_t length, uint64_t *output, size_t *values_written, size_t *bytes_consumed)
+{
+    const uint8_t *start = data;
+    size_t processed = 0;
+    varint_status status = VARINT_OK;
+
+    size_t vl;
+
+    while (length > 0)
+    {
+        vl = __riscv_vsetvl_e8m1(length);
+
+        vuint8m1_t input = __riscv_vle8_v_u8m1(data, vl);
+
+        long error = __riscv_vfirst(vecshift_error_mask_u64(input, vl), vl);
+        if (error >= 0)
+        {
+            // the first marked byte is the tenth byte of the invalid varint
+            status = data[error] > 0x7F ? VARINT_OVERLONG : VARINT_OVERFLOW;
+
+            vl = error - 9;
+            if (vl == 0)
+            {
+                break;
+            }
+        }
+
+        size_t num_varints, number_of_bytes;
+        vuint64m8_t result = vecshift_decode_u64m8(input, vl, &num_varints, &number_of_bytes);
+
+        __riscv_vse64_v_u64m8(output, result, num_varints);
+
+        data += number_of_bytes;
+        length -= number_of_bytes;
+        output += num_varints;
+        processed += num_varints;
+
+        if (status != VARINT_OK)
+        {
+            break;
+        }
+
+        // the last register ends inside a varint that is shorter than 10 bytes
+        if (num_varints == 0 || (vl == length + number_of_bytes && length > 0))
+        {
+            status = VARINT_TRUNCATED;
+            break;
+        }
+    }
+
+    *values_written = processed;
+    *bytes_consumed = data - start;
+    return status;
+}
@@ -64,3 +64,131 @@ size_t varint_decode_scalar(const uint8_t *input, int length, uint32_t *output)
     }
     return out - output;
 }
+
+/**
+ * Bounds checked scalar decoder, reads no byte past input + length.
+ * values_written: number of decoded integers, all varints in front of the first invalid one
+ * bytes_consumed: number of bytes occupied by these varints, i.e. the offset of the invalid varint
+ * returns: VARINT_OK or the error of the first invalid varint
+ */
+varint_status varint_decode_scalar_safe(const uint8_t *input, size_t length, uint32_t *output, size_t *values_written, size_t *bytes_consumed)
+{
+    varint_status status = VARINT_OK;
+    size_t pos = 0;
+    size_t count = 0;
+
+    while (pos < length)
+    {
+        uint32_t result = 0;
+        size_t i = 0;
+        uint8_t b;
+
+        do
+        {
+            if (pos + i == length)
+            {
+                status = VARINT_TRUNCATED;
+                goto done;
+            }
+            b = input[pos + i];
+            result |= (uint32_t)(b & 0x7F) << (7 * i);
+            i++;
+        } while ((b & 0x80) && i < 5);
+
+        if (b & 0x80)
+        {
+            status = VARINT_OVERLONG;
+            goto done;
+        }
+        if (i == 5 && b > 0x0F)
+        {
+            status = VARINT_OVERFLOW;
+            goto done;
+        }
+
+        output[count++] = result;
+        pos += i;
+    }
+done:
+    *values_written = count;
+    *bytes_consumed = pos;
+    return status;
+}
+
+// source https://chromium.googlesource.com/external/github.com/google/protobuf/%2B/refs/heads/master/src/google/protobuf/io/coded_stream.cc#405
+inline __attribute__((always_inline)) const size_t ReadVarint64FromArray(const uint8_t *buffer, uint64_t *value)
+{
+    const uint8_t *ptr = buffer;
+    uint32_t b;
+
+    // Splitting into 32-bit pieces gives better performance on 32-bit processors.
+    uint32_t part0 = 0, part1 = 0, part2 = 0;
+
+    b = *(ptr++);
+    part0 = b;
+    if (!(b & 0x80))
+        goto done;
+    part0 -= 0x80;
+    b = *(ptr++);
+    part0 += b << 7;
+    if (!(b & 0x80))
+        goto done;
+    part0 -= 0x80 << 7;
+    b = *(ptr++);
+    part0 += b << 14;
+    if (!(b & 0x80))
+        goto done;
+    part0 -= 0x80 << 14;
+    b = *(ptr++);
+    part0 += b << 21;
+    if (!(b & 0x80))
+        goto done;
+    part0 -= 0x80 << 21;
+    b = *(ptr++);
+    part1 = b;
+    if (!(b & 0x80))
+        goto done;
+    part1 -= 0x80;
+    b = *(ptr++);
+    part1 += b << 7;
+    if (!(b & 0x80))
+        goto done;
+    part1 -= 0x80 << 7;
+    b = *(ptr++);
+    part1 += b << 14;
+    if (!(b & 0x80))
+        goto done;
+    part1 -= 0x80 << 14;
+    b = *(ptr++);
+    part1 += b << 21;
+    if (!(b & 0x80))
+        goto done;
+    part1 -= 0x80 << 21;
+    b = *(ptr++);
+    part2 = b;
+    if (!(b & 0x80))
+        goto done;
+    part2 -= 0x80;
+    b = *(ptr++);
+    part2 += b << 7;
+    // "part2 -= 0x80 << 7" is irrelevant because (0x80 << 7) << 56 is 0.
+    // A set continuation bit on the tenth byte means the data is corrupt, we
+    // stop after the maximum varint size of 10 bytes anyway.
+
+done:
+    *value = ((uint64_t)part0) | ((uint64_t)part1 << 28) | ((uint64_t)part2 << 56);
+    return ptr - buffer;
+}
+
+size_t varint_decode_scalar_u64(const uint8_t *input, int length, uint64_t *output)
+{
+    uint64_t *out = output;
+    while (length > 0)
+    {
+        size_t bytes_processed = ReadVarint64FromArray(input, out);
+        length -= bytes_processed;
+        input += bytes_processed;
+        out++;
+    }
+    return out - output;
+}
@@ -0,0 +1,38 @@
+#include "libvarintrvv.h"
+#include "varint_vecshift.h"
+
+/**
+ * 64-bit variant of varint_decode_vecshift. Varints are up to 10 bytes long, the bytes of each varint are
+ * gathered with the same slide/compress scheme and combined in 32-bit lanes per 4-byte group, which are then
+ * widened into e64 lanes.
+ *
+ * input: uint8_t pointer to the start of the compressed varints
+ * output: decompressed 64-bit integers
+ * length: size of the varints in bytes
+ * returns: number of decompressed integers
+ */
+size_t varint_decode_u64(const uint8_t *data, size_t length, uint64_t *output)
+{
+    size_t processed = 0;
+
+    size_t vl;
+
+    while (length > 0)
+    {
+        vl = __riscv_vsetvl_e8m1(length);
+
+        vuint8m1_t input = __riscv_vle8_v_u8m1(data, vl);
+
+        size_t num_varints, number_of_bytes;
+        vuint64m8_t result = vecshift_decode_u64m8(input, vl, &num_varints, &number_of_bytes);
+
+        // Store decoded varints
+        __riscv_vse64_v_u64m8(output, result, num_varints);
+
+        data += number_of_bytes;
+        length -= number_of_bytes;
+        output += num_varints;
+        processed += num_varints;
+    }
+    return processed;
+}
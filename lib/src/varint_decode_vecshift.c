@@ -1,5 +1,7 @@
 #include "libvarintrvv.h"
+#include "varint_vecshift.h"
 #include <stdio.h>
+#include <string.h>
 
 size_t varint_decode_vecshift(const uint8_t *data, size_t length, uint32_t *output)
 {
@@ -13,110 +15,323 @@ size_t varint_decode_vecshift(const uint8_t *data, size_t length, uint32_t *outp
 
         vuint8m1_t input = __riscv_vle8_v_u8m1(data, vl);
 
+        size_t num_varints, number_of_bytes;
+        vuint32m4_t result = vecshift_decode_u32m4(input, vl, &num_varints, &number_of_bytes);
+
+        // Store decoded varints
+        __riscv_vse32_v_u32m4(output, result, num_varints);
+
+        data += number_of_bytes;
+        length -= number_of_bytes;
+        output += num_varints;
+        processed += num_varints;
+    }
+    return processed;
+}
+
+size_t varint_decode_vecshift_m2(const uint8_t *data, size_t length, uint32_t *output)
+{
+    size_t processed = 0;
+
+    size_t vl;
+
+    while (length > 0)
+    {
+        vl = __riscv_vsetvl_e8m2(length);
+
+        vuint8m2_t input = __riscv_vle8_v_u8m2(data, vl);
+
+        size_t num_varints, number_of_bytes;
+        vuint32m8_t result = vecshift_decode_u32m8(input, vl, &num_varints, &number_of_bytes);
+
+        // Store decoded varints
+        __riscv_vse32_v_u32m8(output, result, num_varints);
+
+        data += number_of_bytes;
+        length -= number_of_bytes;
+        output += num_varints;
+        processed += num_varints;
+    }
+    return processed;
+}
+
+/**
+ * Combines the payload bytes of one e8/m2 half of the m4 decoder. Bytes of varints that are too short to have them
+ * are zero, so no masks are needed.
+ */
+static inline __attribute__((always_inline)) vuint32m8_t vecshift_combine_u32m8(vuint8m2_t b1, vuint8m2_t b2, vuint8m2_t b3, vuint8m2_t b4,
+                                                                               vuint8m2_t b5, size_t count3, size_t count5, size_t vl)
+{
+    vuint16m4_t result12 = __riscv_vwmaccu(__riscv_vzext_vf2(b1, vl), 128, b2, vl);
+
+    if (count3 == 0)
+    {
+        return __riscv_vzext_vf2(result12, vl);
+    }
+
+    vuint16m4_t result34 = __riscv_vwmaccu(__riscv_vzext_vf2(b3, vl), 128, b4, vl);
+    vuint32m8_t result1234 = __riscv_vwmaccu(__riscv_vzext_vf2(result12, vl), 16384, result34, vl);
+
+    if (count5 == 0)
+    {
+        return result1234;
+    }
+    return __riscv_vadd(result1234, __riscv_vsll(__riscv_vzext_vf4(b5, vl), 28, vl), vl);
+}
+
+/**
+ * LMUL=4 variant. The bytes are gathered at e8/m4, the 32-bit results of a full register would need e32/m16, so
+ * they are combined and stored in two e32/m8 halves.
+ */
+size_t varint_decode_vecshift_m4(const uint8_t *data, size_t length, uint32_t *output)
+{
+    size_t processed = 0;
+
+    size_t vl;
+
+    const size_t half = __riscv_vsetvlmax_e8m2();
+
+    while (length > 0)
+    {
+        vl = __riscv_vsetvl_e8m4(length);
+
+        vuint8m4_t input = __riscv_vle8_v_u8m4(data, vl);
+
         // mask set when element has termination bit (MSB==0) set
-        vbool8_t termination_mask = __riscv_vmsleu(input, 0x7F, vl);
+        vbool2_t termination_mask = __riscv_vmsleu(input, 0x7F, vl);
 
-        // popcount on termination mask tells us number of complete varints in register, as bytes with termination bit set are at the last position in a varint.
         size_t num_varints = __riscv_vcpop(termination_mask, vl);
 
         // fast path. No continuation bits (MSB==1) set
         if (num_varints == vl)
         {
-            // expand every byte to 32-bit lane and save to memory
-            __riscv_vse32_v_u32m4(output, __riscv_vzext_vf4(input, vl), vl);
+            size_t vl_low = vl < half ? vl : half;
+            __riscv_vse32_v_u32m8(output, __riscv_vzext_vf4(__riscv_vget_v_u8m4_u8m2(input, 0), vl_low), vl_low);
+            if (vl > half)
+            {
+                __riscv_vse32_v_u32m8(output + half, __riscv_vzext_vf4(__riscv_vget_v_u8m4_u8m2(input, 1), vl - half), vl - half);
+            }
 
             data += vl;
             length -= vl;
             output += vl;
             processed += vl;
+            continue;
         }
-        else
-        {
 
-            // inspired by https://github.com/camel-cdr/rvv-bench/blob/main/vector-utf/8toN_gather.c
-            vuint8m1_t v1 = __riscv_vslide1down(input, 0, vl);
-            vuint8m1_t v2 = __riscv_vslide1down(v1, 0, vl);
+        vuint8m4_t v1 = __riscv_vslide1down(input, 0, vl);
 
-            // every byte after a termination byte is as first byte
-            vuint8m1_t v_prev = __riscv_vslide1up(input, 0, vl);
-            vbool8_t m_first_bytes = __riscv_vmsleu(v_prev, 0x7F, vl);
+        // every byte after a termination byte is as first byte
+        vuint8m4_t v_prev = __riscv_vslide1up(input, 0, vl);
+        vbool2_t m_first_bytes = __riscv_vmsleu(v_prev, 0x7F, vl);
 
-            // compress the slided input data vectors with the first_byte mask. That way we get the second, third, fourth and fifth byte after each first byte.
-            vuint8m1_t first_bytes = __riscv_vcompress(input, m_first_bytes, vl);
-            vuint8m1_t second_bytes = __riscv_vcompress(v1, m_first_bytes, vl);
+        vuint8m4_t first_bytes = __riscv_vcompress(input, m_first_bytes, vl);
+        vuint8m4_t second_bytes = __riscv_vcompress(v1, m_first_bytes, vl);
 
-            vbool8_t m_second_bytes = __riscv_vmsgtu(first_bytes, 0x7F, vl);
-            vbool8_t m_third_bytes = __riscv_vmand(m_second_bytes, __riscv_vmsgtu(second_bytes, 0x7F, vl), vl);
+        vbool2_t m_second_bytes = __riscv_vmsgtu(first_bytes, 0x7F, vl);
+        vbool2_t m_third_bytes = __riscv_vmand(m_second_bytes, __riscv_vmsgtu(second_bytes, 0x7F, vl), vl);
 
-            // remove continuation bits (bit 7) from payload bytes
-            vuint8m1_t b1 = __riscv_vand(first_bytes, 0x7F, vl);
-            vuint8m1_t b2 = __riscv_vand(second_bytes, 0x7F, vl);
+        size_t count2 = __riscv_vcpop(m_second_bytes, num_varints);
+        size_t count3 = __riscv_vcpop(m_third_bytes, num_varints);
+        size_t count5 = 0;
 
-            // Build result in 16-bit first (fits 14 bits for 2-byte varints)
-            // b1: bits 0-6 b2: bits 7-13 (shift by 7, i.e., multiply by 128)
-            vuint16m2_t result12 = __riscv_vwmaccu_mu(m_second_bytes, __riscv_vzext_vf2(b1, vl), 128, b2,
-                                                      vl);
+        size_t number_of_bytes = num_varints + count2 + count3;
 
-            // Compute byte counts for each varint length
-            // Use num_varints as vl to exclude any incomplete varint at the end
-            size_t count2 = __riscv_vcpop(m_second_bytes, num_varints);
-            size_t count3 = __riscv_vcpop(m_third_bytes, num_varints);
+        // remove continuation bits (bit 7) and zero the bytes that do not belong to the varint
+        vuint8m4_t zero = __riscv_vmv_v_x_u8m4(0, vl);
+        vuint8m4_t b1 = __riscv_vand(first_bytes, 0x7F, vl);
+        vuint8m4_t b2 = __riscv_vand_mu(m_second_bytes, zero, second_bytes, 0x7F, vl);
+        vuint8m4_t b3 = zero, b4 = zero, b5 = zero;
 
-            // Total bytes = sum of bytes per varint
-            size_t number_of_bytes = num_varints + count2 + count3;
+        if (count3 > 0)
+        {
+            vuint8m4_t v2 = __riscv_vslide1down(v1, 0, vl);
+            vuint8m4_t v3 = __riscv_vslide1down(v2, 0, vl);
 
-            if (count3 == 0)
+            vuint8m4_t third_bytes = __riscv_vcompress(v2, m_first_bytes, vl);
+            vuint8m4_t fourth_bytes = __riscv_vcompress(v3, m_first_bytes, vl);
+
+            vbool2_t m_fourth_bytes = __riscv_vmand(m_third_bytes, __riscv_vmsgtu(third_bytes, 0x7F, vl), vl);
+            vbool2_t m_fifth_bytes = __riscv_vmand(m_fourth_bytes, __riscv_vmsgtu(fourth_bytes, 0x7F, vl), vl);
+
+            size_t count4 = __riscv_vcpop(m_fourth_bytes, num_varints);
+            count5 = __riscv_vcpop(m_fifth_bytes, num_varints);
+
+            number_of_bytes += count4 + count5;
+
+            b3 = __riscv_vand_mu(m_third_bytes, zero, third_bytes, 0x7F, vl);
+            b4 = __riscv_vand_mu(m_fourth_bytes, zero, fourth_bytes, 0x7F, vl);
+
+            if (count5 > 0)
             {
-                __riscv_vse32_v_u32m4(output, __riscv_vzext_vf2(result12, vl), num_varints);
+                vuint8m4_t fifth_bytes = __riscv_vcompress(__riscv_vslide1down(v3, 0, vl), m_first_bytes, vl);
+                b5 = __riscv_vand_mu(m_fifth_bytes, zero, fifth_bytes, 0x7F, vl);
             }
-            else
-            {
-                vuint8m1_t v3 = __riscv_vslide1down(v2, 0, vl);
-                vuint8m1_t v4 = __riscv_vslide1down(v3, 0, vl);
+        }
 
-                vuint8m1_t third_bytes = __riscv_vcompress(v2, m_first_bytes, vl);
-                vuint8m1_t fourth_bytes = __riscv_vcompress(v3, m_first_bytes, vl);
+        size_t num_low = num_varints < half ? num_varints : half;
 
-                vbool8_t m_fourth_bytes = __riscv_vmand(m_third_bytes, __riscv_vmsgtu(third_bytes, 0x7F, vl), vl);
-                vbool8_t m_fifth_bytes = __riscv_vmand(m_fourth_bytes, __riscv_vmsgtu(fourth_bytes, 0x7F, vl), vl);
+        vuint32m8_t result_low = vecshift_combine_u32m8(__riscv_vget_v_u8m4_u8m2(b1, 0), __riscv_vget_v_u8m4_u8m2(b2, 0), __riscv_vget_v_u8m4_u8m2(b3, 0),
+                                                        __riscv_vget_v_u8m4_u8m2(b4, 0), __riscv_vget_v_u8m4_u8m2(b5, 0), count3, count5, num_low);
+        __riscv_vse32_v_u32m8(output, result_low, num_low);
 
-                size_t count4 = __riscv_vcpop(m_fourth_bytes, num_varints);
-                size_t count5 = __riscv_vcpop(m_fifth_bytes, num_varints);
+        if (num_varints > half)
+        {
+            vuint32m8_t result_high = vecshift_combine_u32m8(__riscv_vget_v_u8m4_u8m2(b1, 1), __riscv_vget_v_u8m4_u8m2(b2, 1), __riscv_vget_v_u8m4_u8m2(b3, 1),
+                                                             __riscv_vget_v_u8m4_u8m2(b4, 1), __riscv_vget_v_u8m4_u8m2(b5, 1), count3, count5, num_varints - half);
+            __riscv_vse32_v_u32m8(output + half, result_high, num_varints - half);
+        }
 
-                number_of_bytes += count4;
+        data += number_of_bytes;
+        length -= number_of_bytes;
+        output += num_varints;
+        processed += num_varints;
+    }
+    return processed;
+}
 
-                vuint8m1_t b3 = __riscv_vand(third_bytes, 0x7F, vl);
-                vuint8m1_t b4 = __riscv_vand(fourth_bytes, 0x7F, vl);
+/**
+ * Predicts number_of_bytes of the register at data from its last 4 bytes: the register ends after its last
+ * termination byte. The continuation bits of the 4 bytes are read with a scalar load, the number of continuation
+ * bytes at the end is the count of leading zeros of the termination bits / 8. Valid varints have at most 4 bytes
+ * in front of their termination byte, so the prediction is exact for valid input.
+ */
+static inline __attribute__((always_inline)) size_t vecshift_predict_bytes(const uint8_t *data, size_t vl)
+{
+    uint32_t last_bytes;
+    memcpy(&last_bytes, data + vl - 4, sizeof(last_bytes));
 
-                // b3: bits 0-6 b4: bits 7-13 (shift by 7, i.e., multiply by 128)
-                vuint16m2_t result34 = __riscv_vwmaccu_mu(m_fourth_bytes, __riscv_vzext_vf2(b3, vl), 128, b4, vl);
+    uint32_t terminations = ~last_bytes & 0x80808080;
+    return vl - (terminations == 0 ? 4 : __builtin_clz(terminations) / 8);
+}
 
-                // shift result12 left by 14 (multiply with 16384) and add it to result34
-                vuint32m4_t result1234 = __riscv_vwmaccu_mu(m_third_bytes, __riscv_vzext_vf2(result12, vl), 16384, result34, vl);
+/**
+ * Software pipelined varint_decode_vecshift for large inputs. In the plain loop the next vle8 has to wait for
+ * number_of_bytes, which is only known at the end of the kernel. Here the start of the next registers is predicted
+ * with scalar instructions (vecshift_predict_bytes), so the loads of the next two registers are issued before the
+ * current one is decoded. A wrong prediction (only possible for varints longer than 5 bytes) ends the pipelined
+ * loop and the rest is decoded by varint_decode_vecshift, as is the tail of the input.
+ */
+size_t varint_decode_vecshift_pipelined(const uint8_t *data, size_t length, uint32_t *output)
+{
+    const size_t vlmax = __riscv_vsetvlmax_e8m1();
 
-                if (count5 > 0)
-                {
-                    number_of_bytes += count5;
+    size_t processed = 0;
 
-                    vuint8m1_t fifth_bytes = __riscv_vcompress(v4, m_first_bytes, vl);
+    if (length >= 3 * vlmax)
+    {
+        // registers in flight: input0 at data, input1 at data + offset1, input2 at data + offset2
+        vuint8m1_t input0 = __riscv_vle8_v_u8m1(data, vlmax);
+        size_t offset1 = vecshift_predict_bytes(data, vlmax);
+        vuint8m1_t input1 = __riscv_vle8_v_u8m1(data + offset1, vlmax);
+        size_t offset2 = offset1 + vecshift_predict_bytes(data + offset1, vlmax);
 
-                    vuint8m1_t b5 = __riscv_vand(fifth_bytes, 0x7F, vl);
+        while (offset2 + vlmax <= length)
+        {
+            vuint8m1_t input2 = __riscv_vle8_v_u8m1(data + offset2, vlmax);
+            size_t offset3 = offset2 + vecshift_predict_bytes(data + offset2, vlmax);
 
-                    // b5: bits 28-31 (shift by 28)
-                    // vwmaccu cannot be used as the scalar shift value is too large.
-                    result1234 = __riscv_vadd_mu(m_fifth_bytes, result1234, result1234, __riscv_vsll(__riscv_vzext_vf4(b5, vl), 28, vl), vl);
-                }
+            size_t num_varints, number_of_bytes;
+            vuint32m4_t result = vecshift_decode_u32m4(input0, vlmax, &num_varints, &number_of_bytes);
 
-                // Store decoded varints
-                __riscv_vse32_v_u32m4(output, result1234, num_varints);
-            }
+            __riscv_vse32_v_u32m4(output, result, num_varints);
 
             data += number_of_bytes;
             length -= number_of_bytes;
             output += num_varints;
             processed += num_varints;
+
+            if (number_of_bytes != offset1)
+            {
+                break;
+            }
+
+            input0 = input1;
+            input1 = input2;
+            offset1 = offset2 - number_of_bytes;
+            offset2 = offset3 - number_of_bytes;
         }
     }
+
+    return processed + varint_decode_vecshift(data, length, output);
+}
+
+/**
+ * varint_decode_vecshift without reloading the tail of a register. The bytes of the incomplete last varint stay in
+ * the register (vslidedown to lane 0) and the next vle8 only loads the bytes behind them, which are appended with
+ * vslideup. Every input byte is loaded exactly once and the address of the next load does not depend on
+ * number_of_bytes of the kernel.
+ *
+ * bytes_consumed: number of bytes occupied by the decoded varints. It is less than length if the input ends inside
+ * a varint, or if a varint has no termination byte within VLMAX bytes (malformed input), the decoding stops there.
+ * returns: number of decompressed integers
+ */
+size_t varint_decode_vecshift_carry(const uint8_t *data, size_t length, uint32_t *output, size_t *bytes_consumed)
+{
+    const size_t vlmax = __riscv_vsetvlmax_e8m1();
+    const uint8_t *start = data;
+
+    size_t processed = 0;
+
+    vuint8m1_t tail = __riscv_vmv_v_x_u8m1(0, vlmax);
+    size_t carry = 0;
+
+    // carry == vlmax: no termination byte in a full register, only possible for malformed input
+    while (length > 0 && carry < vlmax)
+    {
+        size_t space = vlmax - carry;
+        size_t loaded = __riscv_vsetvl_e8m1(length < space ? length : space);
+        size_t vl = carry + loaded;
+
+        vuint8m1_t bytes = __riscv_vle8_v_u8m1(data, loaded);
+        vuint8m1_t input = carry == 0 ? bytes : __riscv_vslideup(tail, bytes, carry, vl);
+
+        size_t num_varints, number_of_bytes;
+        vuint32m4_t result = vecshift_decode_u32m4(input, vl, &num_varints, &number_of_bytes);
+
+        __riscv_vse32_v_u32m4(output, result, num_varints);
+
+        tail = __riscv_vslidedown(input, number_of_bytes, vl);
+        carry = vl - number_of_bytes;
+
+        data += loaded;
+        length -= loaded;
+        output += num_varints;
+        processed += num_varints;
+    }
+
+    // the carried bytes were loaded but belong to no decoded varint
+    *bytes_consumed = (size_t)(data - start) - carry;
+    return processed;
+}
+
+/**
+ * varint_decode_vecshift with the compress-free fast paths of vecshift_decode_uniform_u32m4 for registers that hold
+ * only 2-byte or only 3-byte varints. Meant for columns dominated by one of these lengths, other data pays the
+ * extra compare and branch per register.
+ */
+size_t varint_decode_vecshift_uniform(const uint8_t *data, size_t length, uint32_t *output)
+{
+    size_t processed = 0;
+
+    size_t vl;
+
+    while (length > 0)
+    {
+        vl = __riscv_vsetvl_e8m1(length);
+
+        vuint8m1_t input = __riscv_vle8_v_u8m1(data, vl);
+
+        size_t num_varints, number_of_bytes;
+        vuint32m4_t result = vecshift_decode_uniform_u32m4(data, input, vl, &num_varints, &number_of_bytes);
+
+        __riscv_vse32_v_u32m4(output, result, num_varints);
+
+        data += number_of_bytes;
+        length -= number_of_bytes;
+        output += num_varints;
+        processed += num_varints;
+    }
     return processed;
 }
 
@@ -0,0 +1,87 @@
+#include "libvarintrvv.h"
+#include "varint_vecshift.h"
+
+/**
+ * Decoders for ZigZag encoded signed varints (protobuf sint32/sint64). The ZigZag transform
+ * (n >> 1) ^ -(n & 1) is applied to the decoded lanes in the vector registers right before the store,
+ * so the output is written only once.
+ */
+
+static inline __attribute__((always_inline)) vuint32m4_t zigzag_decode_u32m4(vuint32m4_t value, size_t vl)
+{
+    // -(n & 1) is all ones for odd values, which flips the bits of the shifted value
+    vuint32m4_t sign = __riscv_vrsub(__riscv_vand(value, 1, vl), 0, vl);
+    return __riscv_vxor(__riscv_vsrl(value, 1, vl), sign, vl);
+}
+
+static inline __attribute__((always_inline)) vuint64m8_t zigzag_decode_u64m8(vuint64m8_t value, size_t vl)
+{
+    vuint64m8_t sign = __riscv_vrsub(__riscv_vand(value, 1, vl), 0, vl);
+    return __riscv_vxor(__riscv_vsrl(value, 1, vl), sign, vl);
+}
+
+/**
+ * input: uint8_t pointer to the start of the compressed varints
+ * output: decompressed signed 32-bit integers
+ * length: size of the varints in bytes
+ * returns: number of decompressed integers
+ */
+size_t varint_decode_zigzag_s32(const uint8_t *data, size_t length, int32_t *output)
+{
+    size_t processed = 0;
+
+    size_t vl;
+
+    while (length > 0)
+    {
+        vl = __riscv_vsetvl_e8m1(length);
+
+        vuint8m1_t input = __riscv_vle8_v_u8m1(data, vl);
+
+        size_t num_varints, number_of_bytes;
+        vuint32m4_t result = vecshift_decode_u32m4(input, vl, &num_varints, &number_of_bytes);
+
+        result = zigzag_decode_u32m4(result, num_varints);
+
+        __riscv_vse32_v_i32m4(output, __riscv_vreinterpret_v_u32m4_i32m4(result), num_varints);
+
+        data += number_of_bytes;
+        length -= number_of_bytes;
+        output += num_varints;
+        processed += num_varints;
+    }
+    return processed;
+}
+
+/**
+ * input: uint8_t pointer to the start of the compressed varints
+ * output: decompressed signed 64-bit integers
+ * length: size of the varints in bytes
+ * returns: number of decompressed integers
+ */
+size_t varint_decode_zigzag_s64(const uint8_t *data, size_t length, int64_t *output)
+{
+    size_t processed = 0;
+
+    size_t vl;
+
+    while (length > 0)
+    {
+        vl = __riscv_vsetvl_e8m1(length);
+
+        vuint8m1_t input = __riscv_vle8_v_u8m1(data, vl);
+
+        size_t num_varints, number_of_bytes;
+        vuint64m8_t result = vecshift_decode_u64m8(input, vl, &num_varints, &number_of_bytes);
+
+        result = zigzag_decode_u64m8(result, num_varints);
+
+        __riscv_vse64_v_i64m8(output, __riscv_vreinterpret_v_u64m8_i64m8(result), num_varints);
+
+        data += number_of_bytes;
+        length -= number_of_bytes;
+        output += num_varints;
+        processed += num_varints;
+    }
+    return processed;
+}
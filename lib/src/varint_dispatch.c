@@ -0,0 +1,179 @@
+#include "libvarintrvv.h"
+
+#if defined(__linux__) && defined(__riscv)
+#include <sys/auxv.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/**
+ * Runtime dispatch for varint_decode and varint_decode_count. The kernels are selected once at load time from the
+ * extensions reported by the riscv_hwprobe syscall and the VLEN of the core. This file and the scalar decoder are
+ * compiled for plain rv64gc (see CMakeLists.txt), so the selection and the fallbacks also run on cores without the
+ * V extension.
+ */
+
+typedef size_t (*varint_decode_fn)(const uint8_t *input, size_t length, uint32_t *output);
+typedef size_t (*varint_count_fn)(const uint8_t *input, size_t length);
+
+#ifndef __NR_riscv_hwprobe
+#define __NR_riscv_hwprobe 258
+#endif
+
+// values from linux/arch/riscv/include/uapi/asm/hwprobe.h
+#define RISCV_HWPROBE_KEY_IMA_EXT_0 4
+#define RISCV_HWPROBE_IMA_C (1ULL << 1)
+#define RISCV_HWPROBE_IMA_V (1ULL << 2)
+#define RISCV_HWPROBE_EXT_ZBA (1ULL << 3)
+#define RISCV_HWPROBE_EXT_ZBB (1ULL << 4)
+#define RISCV_HWPROBE_EXT_ZBS (1ULL << 5)
+#define RISCV_HWPROBE_EXT_ZBC (1ULL << 7)
+#define RISCV_HWPROBE_EXT_ZFH (1ULL << 27)
+
+#define HWCAP_ISA_C (1UL << ('C' - 'A'))
+#define HWCAP_ISA_V (1UL << ('V' - 'A'))
+
+/**
+ * The dispatched kernels are the hand-written assembly in varint_rvv.S, so only the extensions of its instructions
+ * are required: V, Zba for sh2add, Zbb for minu, and C because the assembler may emit compressed encodings. Zbs,
+ * Zbc and Zfh are part of the project -march but are not used by the assembly, so cores without them still get a
+ * vector kernel.
+ */
+#define VECTOR_KERNEL_EXTENSIONS (RISCV_HWPROBE_IMA_V | RISCV_HWPROBE_IMA_C | RISCV_HWPROBE_EXT_ZBA | RISCV_HWPROBE_EXT_ZBB)
+
+/**
+ * varint_count is compiled C, the compiler may use any extension of the project -march in it. The other extensions
+ * of the -march need no probe: Zca and Zcd are part of C, Zkt only constrains timing, and the Zicbop prefetches are
+ * encoded as ori hints that execute as nops on cores without Zicbop.
+ */
+#define COMPILED_KERNEL_EXTENSIONS (VECTOR_KERNEL_EXTENSIONS | RISCV_HWPROBE_EXT_ZBS | RISCV_HWPROBE_EXT_ZBC | RISCV_HWPROBE_EXT_ZFH)
+
+struct riscv_hwprobe_pair
+{
+    int64_t key;
+    uint64_t value;
+};
+
+static uint64_t probe_extensions(void)
+{
+#if defined(__linux__) && defined(__riscv)
+    struct riscv_hwprobe_pair pair = {RISCV_HWPROBE_KEY_IMA_EXT_0, 0};
+
+    if (syscall(__NR_riscv_hwprobe, &pair, 1, 0, NULL, 0) == 0 && pair.key != -1)
+    {
+        return pair.value;
+    }
+
+    // Kernels before 6.4 have no riscv_hwprobe and only report single letter extensions. The multi-letter ones
+    // count as absent, so these cores get the scalar decoder instead of a kernel that may trap on sh2add.
+    unsigned long hwcap = getauxval(AT_HWCAP);
+    return (hwcap & HWCAP_ISA_V ? RISCV_HWPROBE_IMA_V : 0) | (hwcap & HWCAP_ISA_C ? RISCV_HWPROBE_IMA_C : 0);
+#endif
+    return 0;
+}
+
+static size_t read_vlen(void)
+{
+    size_t vlenb = 0;
+#if defined(__riscv)
+    // vlenb CSR, only accessible if the V extension is present
+    __asm__ volatile("csrr %0, 0xc22" : "=r"(vlenb));
+#endif
+    return vlenb * 8;
+}
+
+static size_t decode_scalar(const uint8_t *input, size_t length, uint32_t *output)
+{
+    return varint_decode_scalar(input, (int)length, output);
+}
+
+static size_t count_scalar(const uint8_t *input, size_t length)
+{
+    size_t count = 0;
+    for (size_t i = 0; i < length; i++)
+    {
+        count += input[i] <= 0x7F;
+    }
+    return count;
+}
+
+static varint_decode_fn select_kernel(uint64_t extensions)
+{
+    if ((extensions & VECTOR_KERNEL_EXTENSIONS) != VECTOR_KERNEL_EXTENSIONS)
+    {
+        return decode_scalar;
+    }
+
+    // Provisional, not measured on a VLEN=128 core yet (compare BM<varint_rvv>, BM<varint_rvv_m2> and
+    // BM<varint_rvv_m4> there to revisit): with VLEN=128 an m1 register holds only 16 bytes, so the scalar loop
+    // overhead (vsetvli, vcpop, branches, pointer updates) is paid every 3 to 16 varints, and m2 halves it. From
+    // VLEN=256 on the m1 register holds at least 32 bytes, the overhead is small, and m2 would only raise the cost
+    // of vcompress, which grows faster than LMUL on many cores. varint_rvv_m4 is not selected until it is measured:
+    // it splits every register into two e32/m8 halves, which adds work on top of the larger vcompress.
+    if (read_vlen() < 256)
+    {
+        return varint_rvv_m2;
+    }
+    return varint_rvv;
+}
+
+static varint_count_fn select_count(uint64_t extensions)
+{
+    if ((extensions & COMPILED_KERNEL_EXTENSIONS) != COMPILED_KERNEL_EXTENSIONS)
+    {
+        return count_scalar;
+    }
+    return varint_count;
+}
+
+static size_t decode_resolve(const uint8_t *input, size_t length, uint32_t *output);
+static size_t count_resolve(const uint8_t *input, size_t length);
+
+// resolved by the constructor, the _resolve functions cover calls from constructors that run earlier
+static varint_decode_fn decode_kernel = decode_resolve;
+static varint_count_fn count_kernel = count_resolve;
+
+static void select_kernels(void)
+{
+    uint64_t extensions = probe_extensions();
+    __atomic_store_n(&decode_kernel, select_kernel(extensions), __ATOMIC_RELAXED);
+    __atomic_store_n(&count_kernel, select_count(extensions), __ATOMIC_RELAXED);
+}
+
+static size_t decode_resolve(const uint8_t *input, size_t length, uint32_t *output)
+{
+    select_kernels();
+    return __atomic_load_n(&decode_kernel, __ATOMIC_RELAXED)(input, length, output);
+}
+
+static size_t count_resolve(const uint8_t *input, size_t length)
+{
+    select_kernels();
+    return __atomic_load_n(&count_kernel, __ATOMIC_RELAXED)(input, length);
+}
+
+__attribute__((constructor)) static void varint_dispatch_init(void)
+{
+    select_kernels();
+}
+
+/**
+ * input: uint8_t pointer to the start of the compressed varints
+ * output: decompressed 32-bit integers
+ * length: size of the varints in bytes
+ * returns: number of decompressed integers
+ */
+size_t varint_decode(const uint8_t *input, size_t length, uint32_t *output)
+{
+    return __atomic_load_n(&decode_kernel, __ATOMIC_RELAXED)(input, length, output);
+}
+
+/**
+ * input: uint8_t pointer to the start of the compressed varints
+ * length: size of the varints in bytes
+ * returns: number of varints, like varint_count, also on cores where varint_decode uses the scalar decoder
+ */
+size_t varint_decode_count(const uint8_t *input, size_t length)
+{
+    return __atomic_load_n(&count_kernel, __ATOMIC_RELAXED)(input, length);
+}
@@ -55,4 +55,48 @@ size_t vbyte_encode(const uint32_t *in, size_t length, uint8_t *bout)
         }
     }
     return bout - initbout;
-}
\ No newline at end of file
+}
+
+size_t vbyte_encode_u64(const uint64_t *in, size_t length, uint8_t *bout)
+{
+    uint8_t *initbout = bout;
+    for (size_t k = 0; k < length; ++k)
+    {
+        uint64_t val = in[k];
+
+        // emit 7 bits at a time with the continuation bit set until the rest fits into one byte
+        while (val >= (1ULL << 7))
+        {
+            *bout = (uint8_t)((val & 0x7F) | (1U << 7));
+            ++bout;
+            val >>= 7;
+        }
+        *bout = (uint8_t)val;
+        ++bout;
+    }
+    return bout - initbout;
+}
+
+/**
+ * Size of the varints of in without encoding them: every value takes one byte plus one for each 7-bit threshold it
+ * reaches, counted with compares and vcpop at LMUL=8.
+ * returns: number of bytes vbyte_encode writes for in
+ */
+size_t vbyte_encoded_size(const uint32_t *in, size_t length)
+{
+    size_t size = length;
+
+    size_t vl;
+
+    for (size_t pos = 0; pos < length; pos += vl)
+    {
+        vl = __riscv_vsetvl_e32m8(length - pos);
+
+        vuint32m8_t values = __riscv_vle32_v_u32m8(in + pos, vl);
+        size += __riscv_vcpop_m_b4(__riscv_vmsgeu_vx_u32m8_b4(values, 1U << 7, vl), vl);
+        size += __riscv_vcpop_m_b4(__riscv_vmsgeu_vx_u32m8_b4(values, 1U << 14, vl), vl);
+        size += __riscv_vcpop_m_b4(__riscv_vmsgeu_vx_u32m8_b4(values, 1U << 21, vl), vl);
+        size += __riscv_vcpop_m_b4(__riscv_vmsgeu_vx_u32m8_b4(values, 1U << 28, vl), vl);
+    }
+    return size;
+}
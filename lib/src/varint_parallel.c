@@ -0,0 +1,608 @@
+#include "libvarintrvv.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * Worker pool shared by the parallel decoders and the encoder. The threads are created on first use and then wait
+ * for the next round, so a call pays a wakeup instead of a pthread_create per thread. A round runs parts 1 to
+ * parts - 1 of a function on the workers and part 0 on the calling thread. Rounds from concurrent callers are not
+ * queued: a caller that finds the pool busy, and the parts that no worker could be started for, run on the calling
+ * thread, so a part must never wait for another part of its round.
+ */
+
+#define PARALLEL_MAX_THREADS 64
+
+typedef void (*parallel_part_fn)(void *arg, size_t part);
+
+typedef struct parallel_pool_worker
+{
+    pthread_t thread;
+    size_t part;
+    uint64_t round; // last round seen by the worker
+} parallel_pool_worker;
+
+typedef struct parallel_pool
+{
+    pthread_mutex_t lock;
+    pthread_cond_t start;  // a round was published
+    pthread_cond_t finish; // the last worker of a round is done
+    parallel_pool_worker workers[PARALLEL_MAX_THREADS - 1];
+    size_t num_workers;
+
+    uint64_t round;
+    size_t parts;   // parts of the current round that run on workers, plus part 0
+    size_t pending; // workers that have not finished their part of the current round
+    parallel_part_fn run;
+    void *arg;
+} parallel_pool;
+
+static parallel_pool pool = {PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER};
+
+// held by the caller whose round the pool runs
+static pthread_mutex_t pool_owner = PTHREAD_MUTEX_INITIALIZER;
+
+static void *parallel_pool_main(void *arg)
+{
+    parallel_pool_worker *worker = arg;
+
+    pthread_mutex_lock(&pool.lock);
+    for (;;)
+    {
+        while (pool.round == worker->round)
+        {
+            pthread_cond_wait(&pool.start, &pool.lock);
+        }
+        worker->round = pool.round;
+
+        if (worker->part < pool.parts)
+        {
+            parallel_part_fn run = pool.run;
+            void *run_arg = pool.arg;
+
+            pthread_mutex_unlock(&pool.lock);
+            run(run_arg, worker->part);
+            pthread_mutex_lock(&pool.lock);
+
+            if (--pool.pending == 0)
+            {
+                pthread_cond_signal(&pool.finish);
+            }
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Runs run(arg, part) for every part in [0, parts) and returns when all of them are done.
+ */
+static void parallel_pool_run(parallel_part_fn run, void *arg, size_t parts)
+{
+    if (parts <= 1 || pthread_mutex_trylock(&pool_owner) != 0)
+    {
+        for (size_t i = 0; i < parts; i++)
+        {
+            run(arg, i);
+        }
+        return;
+    }
+
+    pthread_mutex_lock(&pool.lock);
+    while (pool.num_workers < parts - 1)
+    {
+        parallel_pool_worker *worker = &pool.workers[pool.num_workers];
+        worker->part = pool.num_workers + 1;
+        worker->round = pool.round;
+        if (pthread_create(&worker->thread, NULL, parallel_pool_main, worker) != 0)
+        {
+            break;
+        }
+        pool.num_workers++;
+    }
+
+    size_t workers = pool.num_workers < parts - 1 ? pool.num_workers : parts - 1;
+    pool.run = run;
+    pool.arg = arg;
+    pool.parts = workers + 1;
+    pool.pending = workers;
+    pool.round++;
+    pthread_cond_broadcast(&pool.start);
+    pthread_mutex_unlock(&pool.lock);
+
+    run(arg, 0);
+    for (size_t i = workers + 1; i < parts; i++)
+    {
+        run(arg, i);
+    }
+
+    pthread_mutex_lock(&pool.lock);
+    while (pool.pending > 0)
+    {
+        pthread_cond_wait(&pool.finish, &pool.lock);
+    }
+    pthread_mutex_unlock(&pool.lock);
+
+    pthread_mutex_unlock(&pool_owner);
+}
+
+/**
+ * Multi-threaded decoding and encoding of one large buffer in two passes. The input is split into one chunk per
+ * thread. In the first round every thread computes the output size of its chunk (varint_decode_count /
+ * vbyte_encoded_size). The output offsets are the prefix sums of the sizes, in the second round every thread
+ * processes its chunk (varint_decode / vbyte_encode) directly into the final buffer.
+ *
+ * For decoding, every byte with the MSB clear ends a varint, so the chunks are cut at the first termination byte
+ * after the even split points. Both decoding passes go through the runtime dispatch, so varint_decode_parallel also
+ * runs on cores without the V extension. The split is only done if every thread gets at least PARALLEL_MIN_CHUNK
+ * bytes of input.
+ */
+
+#define PARALLEL_MIN_CHUNK (64 * 1024)
+
+typedef struct parallel_chunk
+{
+    const void *input;
+    size_t length; // in input elements
+    size_t size;   // in output elements
+    size_t offset; // in output elements
+    size_t processed;
+} parallel_chunk;
+
+typedef struct parallel_job
+{
+    parallel_chunk chunks[PARALLEL_MAX_THREADS];
+    size_t num_chunks;
+    void *output;
+    size_t output_element_size;
+
+    // output size of a chunk in output elements
+    size_t (*size)(const parallel_chunk *chunk);
+    // processes a chunk to output, returns the number of output elements written
+    size_t (*process)(const parallel_chunk *chunk, void *output);
+} parallel_job;
+
+static void parallel_size_part(void *arg, size_t part)
+{
+    parallel_job *job = arg;
+    job->chunks[part].size = job->size(&job->chunks[part]);
+}
+
+static void parallel_process_part(void *arg, size_t part)
+{
+    parallel_job *job = arg;
+    parallel_chunk *chunk = &job->chunks[part];
+    chunk->processed = job->process(chunk, (uint8_t *)job->output + chunk->offset * job->output_element_size);
+}
+
+/**
+ * Processes all chunks of the job, one pool thread per chunk.
+ * returns: number of output elements written
+ */
+static size_t parallel_run(parallel_job *job)
+{
+    parallel_pool_run(parallel_size_part, job, job->num_chunks);
+
+    size_t offset = 0;
+    for (size_t i = 0; i < job->num_chunks; i++)
+    {
+        job->chunks[i].offset = offset;
+        offset += job->chunks[i].size;
+    }
+
+    parallel_pool_run(parallel_process_part, job, job->num_chunks);
+
+    size_t processed = 0;
+    for (size_t i = 0; i < job->num_chunks; i++)
+    {
+        processed += job->chunks[i].processed;
+    }
+    return processed;
+}
+
+// number of threads for at least PARALLEL_MIN_CHUNK bytes each, num_threads = 0 for one per online CPU
+static size_t parallel_threads(size_t num_threads, size_t bytes)
+{
+    if (num_threads == 0)
+    {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        num_threads = cpus > 0 ? (size_t)cpus : 1;
+    }
+    if (num_threads > PARALLEL_MAX_THREADS)
+    {
+        num_threads = PARALLEL_MAX_THREADS;
+    }
+    if (num_threads > bytes / PARALLEL_MIN_CHUNK)
+    {
+        num_threads = bytes / PARALLEL_MIN_CHUNK;
+    }
+    return num_threads;
+}
+
+static size_t parallel_decode_size(const parallel_chunk *chunk)
+{
+    return varint_decode_count(chunk->input, chunk->length);
+}
+
+static size_t parallel_decode_process(const parallel_chunk *chunk, void *output)
+{
+    return varint_decode(chunk->input, chunk->length, output);
+}
+
+static size_t parallel_encode_size(const parallel_chunk *chunk)
+{
+    return vbyte_encoded_size(chunk->input, chunk->length);
+}
+
+static size_t parallel_encode_process(const parallel_chunk *chunk, void *output)
+{
+    return vbyte_encode(chunk->input, chunk->length, output);
+}
+
+/**
+ * input: uint8_t pointer to the start of the compressed varints
+ * output: decompressed 32-bit integers
+ * length: size of the varints in bytes
+ * num_threads: number of threads including the calling one, 0 for one per online CPU
+ * returns: number of decompressed integers
+ */
+size_t varint_decode_parallel(const uint8_t *input, size_t length, uint32_t *output, size_t num_threads)
+{
+    num_threads = parallel_threads(num_threads, length);
+    if (num_threads <= 1)
+    {
+        return varint_decode(input, length, output);
+    }
+
+    parallel_job job;
+    job.output = output;
+    job.output_element_size = sizeof(uint32_t);
+    job.size = parallel_decode_size;
+    job.process = parallel_decode_process;
+    job.num_chunks = 0;
+
+    // split after the first termination byte at or behind the even split points
+    size_t start = 0;
+    for (size_t i = 1; i <= num_threads && start < length; i++)
+    {
+        size_t end = i == num_threads ? length : length / num_threads * i;
+        if (end <= start)
+        {
+            end = start + 1;
+        }
+        while (end < length && input[end - 1] > 0x7F)
+        {
+            end++;
+        }
+
+        job.chunks[job.num_chunks].input = input + start;
+        job.chunks[job.num_chunks].length = end - start;
+        job.num_chunks++;
+        start = end;
+    }
+
+    return parallel_run(&job);
+}
+
+/**
+ * in: 32-bit integers to encode
+ * length: number of integers
+ * bout: encoded varints, the exact size is vbyte_encoded_size(in, length)
+ * num_threads: number of threads including the calling one, 0 for one per online CPU
+ * returns: size of the varints in bytes
+ */
+size_t vbyte_encode_parallel(const uint32_t *in, size_t length, uint8_t *bout, size_t num_threads)
+{
+    num_threads = parallel_threads(num_threads, length * sizeof(uint32_t));
+    if (num_threads <= 1)
+    {
+        return vbyte_encode(in, length, bout);
+    }
+
+    parallel_job job;
+    job.output = bout;
+    job.output_element_size = 1;
+    job.size = parallel_encode_size;
+    job.process = parallel_encode_process;
+    job.num_chunks = num_threads;
+
+    for (size_t i = 0; i < num_threads; i++)
+    {
+        size_t start = length / num_threads * i;
+        size_t end = i + 1 == num_threads ? length : length / num_threads * (i + 1);
+        job.chunks[i].input = in + start;
+        job.chunks[i].length = end - start;
+    }
+
+    return parallel_run(&job);
+}
+
+/**
+ * Work-stealing decoder for batches of buffers of very different sizes. The batch is turned into tasks of about
+ * STEAL_TASK_BYTES: runs of small buffers are one task (varint_decode_batch), buffers larger than that are cut into
+ * pieces at termination bytes. The tasks are dealt to the threads in contiguous ranges, every thread takes tasks
+ * from the front of its own range and steals from the back of the others once it is empty. A range is a single
+ * 64-bit word (head, tail) that is updated with compare-and-swap by the owner and the thieves.
+ *
+ * Pieces of one buffer need their output offsets, so the decoding is preceded by a phase that counts the varints of
+ * all pieces (varint_count) with the same scheduler. Tasks do not create new tasks, so a thread that finds all
+ * ranges empty is done.
+ */
+
+#define STEAL_TASK_BYTES (64 * 1024)
+
+typedef struct steal_task
+{
+    varint_batch_entry *entry;
+    size_t num_entries; // 0 for a piece of entry
+    size_t start;       // byte range of a piece
+    size_t end;
+    size_t count;  // varints of a piece, set in the count phase
+    size_t offset; // output offset of a piece
+    size_t decoded;
+} steal_task;
+
+typedef struct steal_range
+{
+    uint64_t head_tail;
+    uint8_t padding[56]; // one range per cache line
+} steal_range;
+
+typedef struct steal_job
+{
+    steal_task *tasks;
+    steal_range ranges[PARALLEL_MAX_THREADS];
+    size_t num_threads;
+    int counting;
+    varint_thread_stats *stats;
+} steal_job;
+
+static inline uint64_t steal_pack(uint64_t head, uint64_t tail)
+{
+    return head << 32 | tail;
+}
+
+// returns: the task at the front (own range) or back (stolen) of the range, -1 if the range is empty
+static long steal_take(steal_range *range, int back)
+{
+    uint64_t head_tail = __atomic_load_n(&range->head_tail, __ATOMIC_ACQUIRE);
+    for (;;)
+    {
+        uint64_t head = head_tail >> 32;
+        uint64_t tail = head_tail & 0xFFFFFFFF;
+        if (head >= tail)
+        {
+            return -1;
+        }
+
+        uint64_t next = back ? steal_pack(head, tail - 1) : steal_pack(head + 1, tail);
+        if (__atomic_compare_exchange_n(&range->head_tail, &head_tail, next, 1, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+        {
+            return back ? (long)(tail - 1) : (long)head;
+        }
+    }
+}
+
+static void steal_execute(const steal_job *job, steal_task *task)
+{
+    if (task->num_entries > 0)
+    {
+        task->decoded = varint_decode_batch(task->entry, task->num_entries);
+        return;
+    }
+
+    const uint8_t *input = task->entry->input + task->start;
+    size_t length = task->end - task->start;
+
+    if (job->counting)
+    {
+        task->count = varint_count(input, length);
+    }
+    else if (input[length - 1] <= 0x7F)
+    {
+        task->decoded = varint_decode(input, length, task->entry->output + task->offset);
+    }
+    else
+    {
+        // the last piece of a truncated buffer
+        size_t bytes_consumed;
+        task->decoded = varint_decode_vecshift_bounded(input, length, task->entry->output + task->offset, SIZE_MAX, &bytes_consumed);
+    }
+}
+
+static inline uint64_t steal_now_ns(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000 + (uint64_t)now.tv_nsec;
+}
+
+static void steal_worker_run(void *arg, size_t self)
+{
+    steal_job *job = arg;
+    varint_thread_stats stats = {0, 0, 0};
+
+    for (;;)
+    {
+        long task = steal_take(&job->ranges[self], 0);
+        for (size_t i = 1; task < 0 && i < job->num_threads; i++)
+        {
+            task = steal_take(&job->ranges[(self + i) % job->num_threads], 1);
+            stats.steals += task >= 0;
+        }
+        if (task < 0)
+        {
+            break;
+        }
+
+        uint64_t start = job->stats ? steal_now_ns() : 0;
+        steal_execute(job, &job->tasks[task]);
+        stats.busy_ns += job->stats ? steal_now_ns() - start : 0;
+        stats.tasks++;
+    }
+
+    if (job->stats)
+    {
+        job->stats[self].busy_ns += stats.busy_ns;
+        job->stats[self].tasks += stats.tasks;
+        job->stats[self].steals += stats.steals;
+    }
+}
+
+// runs tasks [0, num_tasks) on all threads of the job
+static void steal_run(steal_job *job, size_t num_tasks)
+{
+    for (size_t i = 0; i < job->num_threads; i++)
+    {
+        size_t head = num_tasks * i / job->num_threads;
+        size_t tail = num_tasks * (i + 1) / job->num_threads;
+        __atomic_store_n(&job->ranges[i].head_tail, steal_pack(head, tail), __ATOMIC_RELAXED);
+    }
+
+    // threads that run after the others (no pool worker) find their range stolen
+    parallel_pool_run(steal_worker_run, job, job->num_threads);
+}
+
+// end of the run of small buffers (together at most STEAL_TASK_BYTES) that starts at entry first
+static size_t steal_group_end(const varint_batch_entry *entries, size_t num_entries, size_t first)
+{
+    size_t i = first;
+    size_t bytes = 0;
+    while (i < num_entries && entries[i].length <= STEAL_TASK_BYTES && bytes + entries[i].length <= STEAL_TASK_BYTES)
+    {
+        bytes += entries[i].length;
+        i++;
+    }
+    return i;
+}
+
+/**
+ * entries: input, length and output of every buffer, count receives the number of integers decoded from it
+ * num_threads: number of threads including the calling one, 0 for one per online CPU
+ * stats: NULL or num_threads entries, the work of every thread is added to them (num_threads must not be 0)
+ * returns: number of decompressed integers of all buffers
+ */
+size_t varint_decode_batch_parallel(varint_batch_entry *entries, size_t num_entries, size_t num_threads, varint_thread_stats *stats)
+{
+    size_t total_bytes = 0;
+    size_t num_tasks = 0;
+
+    // tasks: pieces of large buffers first, they are the only ones in the count phase, then groups of small ones
+    for (size_t i = 0; i < num_entries;)
+    {
+        if (entries[i].length > STEAL_TASK_BYTES)
+        {
+            total_bytes += entries[i].length;
+            num_tasks += entries[i].length / STEAL_TASK_BYTES + 1;
+            i++;
+            continue;
+        }
+
+        size_t end = steal_group_end(entries, num_entries, i);
+        for (; i < end; i++)
+        {
+            total_bytes += entries[i].length;
+        }
+        num_tasks++;
+    }
+
+    steal_task *tasks = NULL;
+    if (num_threads != 1 && total_bytes >= 2 * STEAL_TASK_BYTES)
+    {
+        tasks = malloc(num_tasks * sizeof(steal_task));
+    }
+    if (tasks == NULL)
+    {
+        uint64_t start = stats ? steal_now_ns() : 0;
+        size_t processed = varint_decode_batch(entries, num_entries);
+        if (stats)
+        {
+            stats[0].busy_ns += steal_now_ns() - start;
+            stats[0].tasks++;
+        }
+        return processed;
+    }
+
+    steal_job job;
+    job.tasks = tasks;
+    job.num_threads = parallel_threads(num_threads, SIZE_MAX);
+    job.stats = stats;
+
+    size_t num_pieces = 0;
+    for (size_t i = 0; i < num_entries; i++)
+    {
+        const uint8_t *input = entries[i].input;
+        size_t length = entries[i].length;
+        if (length <= STEAL_TASK_BYTES)
+        {
+            continue;
+        }
+
+        for (size_t start = 0; start < length;)
+        {
+            size_t end = length - start > STEAL_TASK_BYTES ? start + STEAL_TASK_BYTES : length;
+            while (end < length && input[end - 1] > 0x7F)
+            {
+                end++;
+            }
+
+            steal_task *task = &tasks[num_pieces++];
+            task->entry = &entries[i];
+            task->num_entries = 0;
+            task->start = start;
+            task->end = end;
+            start = end;
+        }
+    }
+
+    size_t num_groups = num_pieces;
+    for (size_t i = 0; i < num_entries;)
+    {
+        if (entries[i].length > STEAL_TASK_BYTES)
+        {
+            i++;
+            continue;
+        }
+
+        size_t first = i;
+        i = steal_group_end(entries, num_entries, first);
+
+        steal_task *task = &tasks[num_groups++];
+        task->entry = &entries[first];
+        task->num_entries = i - first;
+    }
+
+    if (num_pieces > 0)
+    {
+        job.counting = 1;
+        steal_run(&job, num_pieces);
+    }
+
+    // output offsets of the pieces, the pieces of one buffer are consecutive
+    for (size_t i = 0; i < num_pieces; i++)
+    {
+        int first_piece = i == 0 || tasks[i - 1].entry != tasks[i].entry;
+        tasks[i].offset = first_piece ? 0 : tasks[i - 1].offset + tasks[i - 1].count;
+    }
+
+    job.counting = 0;
+    steal_run(&job, num_groups);
+
+    size_t processed = 0;
+    for (size_t i = 0; i < num_groups; i++)
+    {
+        if (i < num_pieces && (i == 0 || tasks[i - 1].entry != tasks[i].entry))
+        {
+            tasks[i].entry->count = 0;
+        }
+        if (i < num_pieces)
+        {
+            tasks[i].entry->count += tasks[i].decoded;
+        }
+        processed += tasks[i].decoded;
+    }
+
+    free(tasks);
+    return processed;
+}
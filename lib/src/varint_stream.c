@@ -0,0 +1,136 @@
+#include "libvarintrvv.h"
+
+/**
+ * Streaming decoder for input that arrives in chunks. Varints may straddle chunk boundaries: the bytes of a varint
+ * that is not terminated at the end of a chunk are folded into the stream state (payload bits and byte count), so
+ * no chunk is copied. The next feed completes the pending varint with a few scalar steps and passes the remaining
+ * complete varints directly to the vector kernel, i.e. the per-chunk overhead is constant.
+ *
+ * A stream has to be fed either with varint_stream_feed or with varint_stream_feed_u64, not with both.
+ */
+
+#define STREAM_MAX_BYTES 10
+
+void varint_stream_init(varint_stream *stream)
+{
+    stream->pending_value = 0;
+    stream->pending_bytes = 0;
+}
+
+/**
+ * Appends the bytes at the start of input to the pending varint, up to and including its termination byte.
+ * returns: number of bytes taken, the varint is complete if the last taken byte is a termination byte
+ */
+static size_t stream_take(varint_stream *stream, const uint8_t *input, size_t length)
+{
+    size_t taken = 0;
+    while (taken < length)
+    {
+        uint8_t byte = input[taken++];
+        // bytes beyond the 10th of a malformed varint carry no payload bits
+        if (stream->pending_bytes < STREAM_MAX_BYTES)
+        {
+            stream->pending_value |= (uint64_t)(byte & 0x7F) << (7 * stream->pending_bytes);
+            stream->pending_bytes++;
+        }
+        if (byte < 0x80)
+        {
+            break;
+        }
+    }
+    return taken;
+}
+
+static inline __attribute__((always_inline)) uint64_t stream_pop(varint_stream *stream)
+{
+    uint64_t value = stream->pending_value;
+    varint_stream_init(stream);
+    return value;
+}
+
+// length of the input up to and including the last termination byte
+static inline __attribute__((always_inline)) size_t stream_complete_length(const uint8_t *input, size_t length)
+{
+    while (length > 0 && input[length - 1] > 0x7F)
+    {
+        length--;
+    }
+    return length;
+}
+
+/**
+ * input: next chunk of the compressed varints
+ * length: size of the chunk in bytes
+ * output: decompressed 32-bit integers, the varints that end in this chunk
+ * returns: number of decompressed integers
+ */
+size_t varint_stream_feed(varint_stream *stream, const uint8_t *input, size_t length, uint32_t *output)
+{
+    size_t processed = 0;
+
+    if (length == 0)
+    {
+        return 0;
+    }
+
+    if (stream->pending_bytes > 0)
+    {
+        size_t taken = stream_take(stream, input, length);
+        if (input[taken - 1] > 0x7F)
+        {
+            // the chunk ends inside the pending varint
+            return 0;
+        }
+        output[processed++] = (uint32_t)stream_pop(stream);
+        input += taken;
+        length -= taken;
+    }
+
+    size_t complete = stream_complete_length(input, length);
+    processed += varint_decode(input, complete, output + processed);
+    stream_take(stream, input + complete, length - complete);
+
+    return processed;
+}
+
+/**
+ * 64-bit variant of varint_stream_feed
+ */
+size_t varint_stream_feed_u64(varint_stream *stream, const uint8_t *input, size_t length, uint64_t *output)
+{
+    size_t processed = 0;
+
+    if (length == 0)
+    {
+        return 0;
+    }
+
+    if (stream->pending_bytes > 0)
+    {
+        size_t taken = stream_take(stream, input, length);
+        if (input[taken - 1] > 0x7F)
+        {
+            return 0;
+        }
+        output[processed++] = stream_pop(stream);
+        input += taken;
+        length -= taken;
+    }
+
+    size_t complete = stream_complete_length(input, length);
+    processed += varint_decode_u64(input, complete, output + processed);
+    stream_take(stream, input + complete, length - complete);
+
+    return processed;
+}
+
+/**
+ * Ends the stream and resets it for the next one.
+ * returns: VARINT_TRUNCATED if the last chunk ended inside a varint, VARINT_OK otherwise
+ */
+varint_status varint_stream_finish(varint_stream *stream)
+{
+    varint_status status = stream->pending_bytes > 0 ? VARINT_TRUNCATED : VARINT_OK;
+    varint_stream_init(stream);
+    return status;
+}
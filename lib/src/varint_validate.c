@@ -0,0 +1,82 @@
+#include "libvarintrvv.h"
+
+/**
+ * Validation without decoding. A varint is invalid if its fifth (tenth for 64-bit) byte follows four (nine)
+ * continuation bytes and has bits set beyond the 32 (64) value bits, i.e. is > 0x0F (> 0x01). A byte > 0x7F at
+ * that position makes the varint overlong, any other value overflows.
+ *
+ * The bytes in front of a position are read with unaligned loads at offsets -1, -2, ... instead of slides, so the
+ * whole check runs at LMUL=8 with one compare per load and the results are combined with mask instructions only.
+ * Nothing is widened or stored. Positions before the fifth (tenth) byte of the buffer cannot hold an invalid byte
+ * and are skipped, which keeps all loads inside the buffer.
+ */
+
+static inline __attribute__((always_inline)) varint_status validate_error_status(const uint8_t *data, long error)
+{
+    return data[error] > 0x7F ? VARINT_OVERLONG : VARINT_OVERFLOW;
+}
+
+static inline __attribute__((always_inline)) varint_status validate_truncated(const uint8_t *input, size_t length)
+{
+    return length > 0 && input[length - 1] > 0x7F ? VARINT_TRUNCATED : VARINT_OK;
+}
+
+/**
+ * input: uint8_t pointer to the start of the compressed varints
+ * length: size of the varints in bytes
+ * returns: VARINT_OK or the error of the first invalid varint
+ */
+varint_status varint_validate(const uint8_t *input, size_t length)
+{
+    size_t vl;
+
+    for (size_t pos = 4; pos < length; pos += vl)
+    {
+        vl = __riscv_vsetvl_e8m8(length - pos);
+        const uint8_t *data = input + pos;
+
+        vbool1_t error = __riscv_vmsgtu_vx_u8m8_b1(__riscv_vle8_v_u8m8(data, vl), 0x0F, vl);
+        for (size_t back = 1; back <= 4; back++)
+        {
+            vbool1_t continuation = __riscv_vmsgtu_vx_u8m8_b1(__riscv_vle8_v_u8m8(data - back, vl), 0x7F, vl);
+            error = __riscv_vmand_mm_b1(error, continuation, vl);
+        }
+
+        long first = __riscv_vfirst_m_b1(error, vl);
+        if (first >= 0)
+        {
+            return validate_error_status(data, first);
+        }
+    }
+
+    return validate_truncated(input, length);
+}
+
+/**
+ * 64-bit variant, varints of up to 10 bytes whose last byte is 0x00 or 0x01
+ */
+varint_status varint_validate_u64(const uint8_t *input, size_t length)
+{
+    size_t vl;
+
+    for (size_t pos = 9; pos < length; pos += vl)
+    {
+        vl = __riscv_vsetvl_e8m8(length - pos);
+        const uint8_t *data = input + pos;
+
+        vbool1_t error = __riscv_vmsgtu_vx_u8m8_b1(__riscv_vle8_v_u8m8(data, vl), 0x01, vl);
+        for (size_t back = 1; back <= 9; back++)
+        {
+            vbool1_t continuation = __riscv_vmsgtu_vx_u8m8_b1(__riscv_vle8_v_u8m8(data - back, vl), 0x7F, vl);
+            error = __riscv_vmand_mm_b1(error, continuation, vl);
+        }
+
+        long first = __riscv_vfirst_m_b1(error, vl);
+        if (first >= 0)
+        {
+            return validate_error_status(data, first);
+        }
+    }
+
+    return validate_truncated(input, length);
+}